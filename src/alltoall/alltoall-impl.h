@@ -54,5 +54,10 @@
 
 extern void shmemi_alltoall32_linear ();
 extern void shmemi_alltoall64_linear ();
+extern void shmemi_alltoallv_linear ();
+
+extern void shmemi_alltoall32_pairwise ();
+extern void shmemi_alltoall64_pairwise ();
+extern void shmemi_alltoallv_pairwise ();
 
 #endif /* _ALLTOALL_IMPL_H */
@@ -82,3 +82,31 @@
 
 SHMEM_ALLTOALL_TYPE (32, 4);
 SHMEM_ALLTOALL_TYPE (64, 8);
+
+/*
+ * alltoallv: counts[i] bytes are fetched from offsets[i] in the
+ * source of the i'th PE in the set, and packed into target in set
+ * order.  The barrier keeps the sources alive until everyone has
+ * read them.
+ *
+ */
+
+void
+shmemi_alltoallv_linear (void *target, const void *source,
+                         const size_t *counts, const size_t *offsets,
+                         int PE_start, int logPE_stride, int PE_size,
+                         long *pSync)
+{
+    const int step = 1 << logPE_stride;
+    char *tp = (char *) target;
+    int pe, i;
+
+    for (i = 0, pe = PE_start; i < PE_size; i += 1, pe += step) {
+        if (counts[i] > 0) {
+            shmem_getmem (tp, (const char *) source + offsets[i],
+                          counts[i], pe);
+            tp += counts[i];
+        }
+    }
+    shmem_barrier (PE_start, logPE_stride, PE_size, pSync);
+}
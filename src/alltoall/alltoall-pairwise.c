@@ -0,0 +1,189 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "state.h"
+#include "trace.h"
+#include "utils.h"
+
+#include "shmem.h"
+
+/**
+ * Each PE pushes its block for every other PE in the set, starting
+ * with its right-hand neighbour (pe = me + i mod PE_size) so that the
+ * PEs don't all hit PE_start at the same time.
+ *
+ * With unit strides the blocks go out as contiguous non-blocking
+ * puts.  Otherwise the source block is packed into a contiguous
+ * buffer first; if the target is strided too, the packed block is
+ * scattered on the target side by iput.
+ *
+ * A quiet and a barrier on the set make sure all data has landed
+ * before anyone returns.
+ *
+ */
+
+#define SHMEM_ALLTOALL_TYPE(Name, Type)                                 \
+    void                                                                \
+    shmemi_alltoall##Name##_pairwise (void *target, const void *source, \
+                                      ptrdiff_t dst, ptrdiff_t sst,     \
+                                      size_t nelems,                    \
+                                      int PE_start,                     \
+                                      int logPE_stride, int PE_size,    \
+                                      long *pSync)                      \
+    {                                                                   \
+        const int me = GET_STATE(mype);                                 \
+        const int vme = (me - PE_start) >> logPE_stride;                \
+        const size_t blk = nelems * sizeof (Type);                      \
+        const int contig = (dst == 1) && (sst == 1);                    \
+        Type *tp = (Type *) target + dst * nelems * vme;                \
+        Type *packed = NULL;                                            \
+        int i;                                                          \
+                                                                        \
+        if ( (! contig) && (nelems > 0) ) {                             \
+            packed = (Type *) malloc (blk);                             \
+            if (EXPR_UNLIKELY (packed == (Type *) NULL)) {              \
+                shmemi_trace (SHMEM_LOG_FATAL,                          \
+                              "unable to allocate %ld bytes for "       \
+                              "alltoall packing buffer",                \
+                              blk);                                     \
+                return;                                                 \
+                /* NOT REACHED */                                       \
+            }                                                           \
+        }                                                               \
+                                                                        \
+        for (i = 0; i < PE_size; i += 1) {                              \
+            const int vpe = (vme + i) % PE_size;                        \
+            const int pe = PE_start + (vpe << logPE_stride);            \
+            const Type *sp =                                            \
+                (const Type *) source + sst * nelems * vpe;             \
+                                                                        \
+            if (contig) {                                               \
+                shmem_putmem_nbi (tp, sp, blk, pe);                     \
+            }                                                           \
+            else {                                                      \
+                size_t j;                                               \
+                                                                        \
+                for (j = 0; j < nelems; j += 1) {                       \
+                    packed[j] = sp[j * sst];                            \
+                }                                                       \
+                if (dst == 1) {                                         \
+                    shmem_putmem (tp, packed, blk, pe);                 \
+                }                                                       \
+                else {                                                  \
+                    shmem_iput##Name (tp, packed, dst, 1, nelems, pe);  \
+                }                                                       \
+            }                                                           \
+                                                                        \
+            shmemi_trace (SHMEM_LOG_ALLTOALL,                           \
+                          "sent %ld elements to PE %d",                 \
+                          nelems, pe);                                  \
+        }                                                               \
+                                                                        \
+        free (packed);                                                  \
+                                                                        \
+        shmem_quiet ();                                                 \
+        shmem_barrier (PE_start, logPE_stride, PE_size, pSync);         \
+    }
+
+SHMEM_ALLTOALL_TYPE (32, uint32_t);
+SHMEM_ALLTOALL_TYPE (64, uint64_t);
+
+/*
+ * alltoallv: the receiver doesn't know the senders' layout until the
+ * counts have been exchanged, so here each PE pulls its blocks,
+ * again starting with its right-hand neighbour, as non-blocking gets
+ * into its packed target.
+ *
+ */
+
+void
+shmemi_alltoallv_pairwise (void *target, const void *source,
+                           const size_t *counts, const size_t *offsets,
+                           int PE_start, int logPE_stride, int PE_size,
+                           long *pSync)
+{
+    const int me = GET_STATE(mype);
+    const int vme = (me - PE_start) >> logPE_stride;
+    char *tp = (char *) target;
+    int i;
+
+    /* where each block lands: everything from lower PEs goes first */
+    for (i = 0; i < vme; i += 1) {
+        tp += counts[i];
+    }
+
+    for (i = 0; i < PE_size; i += 1) {
+        const int vpe = (vme + i) % PE_size;
+        const int pe = PE_start + (vpe << logPE_stride);
+
+        if (vpe == 0) {
+            tp = (char *) target;
+        }
+        if (counts[vpe] > 0) {
+            shmem_getmem_nbi (tp, (const char *) source + offsets[vpe],
+                              counts[vpe], pe);
+            tp += counts[vpe];
+        }
+
+        shmemi_trace (SHMEM_LOG_ALLTOALL,
+                      "fetching %ld bytes from PE %d",
+                      counts[vpe], pe);
+    }
+
+    shmem_quiet ();
+    shmem_barrier (PE_start, logPE_stride, PE_size, pSync);
+}
@@ -56,6 +56,7 @@
 #include "comms.h"
 #include "trace.h"
 #include "utils.h"
+#include "tune.h"
 
 #include "shmem.h"
 
@@ -65,14 +66,30 @@
 #include "pshmem.h"
 #endif /* HAVE_FEATURE_PSHMEM */
 
+#ifdef HAVE_FEATURE_EXPERIMENTAL
+#include "shmemx.h"
+#ifdef HAVE_FEATURE_PSHMEM
+#include "pshmemx.h"
+#endif /* HAVE_FEATURE_PSHMEM */
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
+
 /*
  * TODO: tree is currently unimplemented, don't use it.
  */
 
-static char *default_implementation = "linear";
+static char *default_implementation = "pairwise";
+
+static const shmemi_tune_algorithm_t algorithms[] = {
+    { "linear",
+      shmemi_alltoall32_linear, shmemi_alltoall64_linear,
+      shmemi_alltoallv_linear },
+    { "pairwise",
+      shmemi_alltoall32_pairwise, shmemi_alltoall64_pairwise,
+      shmemi_alltoallv_pairwise },
+};
 
-static void (*func32) ();
-static void (*func64) ();
+static int chosen;
+static int use_table = 1;
 
 /*
  * called during initialization of shmem
@@ -83,29 +100,48 @@ void
 shmemi_alltoall_dispatch_init (void)
 {
     char *name = shmemi_comms_getenv ("SHMEM_ALLTOALL_ALGORITHM");
+
     if (EXPR_LIKELY (name == (char *) NULL)) {
         name = default_implementation;
     }
-
-    if (strcmp (name, "linear") == 0) {
-        func32 = shmemi_alltoall32_linear;
-        func64 = shmemi_alltoall64_linear;
-    }
-#if 0
-    else if (strcmp (name, "tree") == 0) {
-        func32 = shmemi_alltoall32_tree;
-        func64 = shmemi_alltoall64_tree;
-    }
-#endif
     else {
-        ;                       /* error */
+        use_table = 0;          /* user asked for this one */
+    }
+
+    chosen = shmemi_tune_find (algorithms, TUNE_COUNT (algorithms), name);
+    if (EXPR_UNLIKELY (chosen < 0)) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "unsupported alltoall \"%s\"",
+                      name);
+        return;
+        /* NOT REACHED */
     }
+
+    shmemi_tune_register (TUNE_ALLTOALL, algorithms, TUNE_COUNT (algorithms));
+
     /*
      * report which alltoall implementation we set up
      */
     shmemi_trace (SHMEM_LOG_ALLTOALL, "using alltoall \"%s\"", name);
 }
 
+/**
+ * the tuning table, if any, can pick a better algorithm for this
+ * call's shape
+ */
+static inline const shmemi_tune_algorithm_t *
+pick (int PE_size, size_t nbytes)
+{
+    if (use_table) {
+        const int i = shmemi_tune_lookup (TUNE_ALLTOALL, PE_size, nbytes);
+
+        if (i >= 0) {
+            return &algorithms[i];
+        }
+    }
+    return &algorithms[chosen];
+}
+
 /*
  * the rest is what library users see
  *
@@ -132,7 +168,7 @@ shmem_alltoall32 (void *target, const void* source, size_t nelems,
     SYMMETRY_CHECK (source, 2, debug_name);
     SYMMETRY_CHECK (pSync,  7, debug_name);
 
-    func32 (target, source, 1, 1, nelems,
+    pick (PE_size, nelems * 4)->func32 (target, source, 1, 1, nelems,
             PE_start, logPE_stride, PE_size, pSync);
 }
 
@@ -154,7 +190,7 @@ shmem_alltoall64 (void *target, const void* source, size_t nelems,
     SYMMETRY_CHECK (source, 2, debug_name);
     SYMMETRY_CHECK (pSync,  7, debug_name);
 
-    func64 (target, source, 1, 1, nelems,
+    pick (PE_size, nelems * 8)->func64 (target, source, 1, 1, nelems,
             PE_start, logPE_stride, PE_size, pSync);
 }
 
@@ -177,7 +213,7 @@ shmem_alltoalls32 (void *target, const void* source,
     SYMMETRY_CHECK (source, 2, debug_name);
     SYMMETRY_CHECK (pSync,  9, debug_name);
 
-    func32 (target, source, dst, sst, nelems,
+    pick (PE_size, nelems * 4)->func32 (target, source, dst, sst, nelems,
             PE_start, logPE_stride, PE_size, pSync);
 }
 
@@ -200,6 +236,93 @@ shmem_alltoalls64 (void *target, const void* source,
     SYMMETRY_CHECK (source, 2, debug_name);
     SYMMETRY_CHECK (pSync,  9, debug_name);
 
-    func64 (target, source, dst, sst, nelems,
+    pick (PE_size, nelems * 8)->func64 (target, source, dst, sst, nelems,
             PE_start, logPE_stride, PE_size, pSync);
 }
+
+#ifdef HAVE_FEATURE_EXPERIMENTAL
+
+/*
+ * one size_t from each PE in the set to each other, through the
+ * ordinary alltoall
+ *
+ */
+static void
+exchange (size_t *target, const size_t *source,
+          int PE_start, int logPE_stride, int PE_size, long *pSync)
+{
+    const shmemi_tune_algorithm_t *a = pick (PE_size, sizeof (size_t));
+
+    if (sizeof (size_t) == 8) {
+        a->func64 (target, source, 1, 1, 1,
+                   PE_start, logPE_stride, PE_size, pSync);
+    }
+    else {
+        a->func32 (target, source, 1, 1, 1,
+                   PE_start, logPE_stride, PE_size, pSync);
+    }
+}
+
+#ifdef HAVE_FEATURE_PSHMEM
+#pragma weak shmemx_alltoallv = pshmemx_alltoallv
+#define shmemx_alltoallv pshmemx_alltoallv
+#endif /* HAVE_FEATURE_PSHMEM */
+
+/**
+ * Each PE sends source_counts[i] bytes from source_displs[i] in its
+ * source to the i'th PE in the set.  The counts are exchanged first,
+ * so the receivers learn what is coming: on return target_counts[i]
+ * and target_displs[i] say how many bytes came from the i'th PE and
+ * where they were put in target, where the blocks are packed in set
+ * order.
+ *
+ * All four arrays have PE_size entries and must be symmetric.
+ */
+
+void
+shmemx_alltoallv (void *target, size_t *target_counts, size_t *target_displs,
+                  const void *source, const size_t *source_counts,
+                  const size_t *source_displs,
+                  int PE_start, int logPE_stride, int PE_size,
+                  long *pSync)
+{
+    DEBUG_NAME ("shmemx_alltoallv");
+    size_t sent = 0;
+    size_t off = 0;
+    int i;
+
+    INIT_CHECK (debug_name);
+    shmem_quiet ();
+
+    SYMMETRY_CHECK (target, 1, debug_name);
+    SYMMETRY_CHECK (target_counts, 2, debug_name);
+    SYMMETRY_CHECK (target_displs, 3, debug_name);
+    SYMMETRY_CHECK (source, 4, debug_name);
+    SYMMETRY_CHECK (source_counts, 5, debug_name);
+    SYMMETRY_CHECK (source_displs, 6, debug_name);
+    SYMMETRY_CHECK (pSync, 10, debug_name);
+
+    /* for now target_displs holds where my blocks are in the sources */
+    exchange (target_counts, source_counts,
+              PE_start, logPE_stride, PE_size, pSync);
+    exchange (target_displs, source_displs,
+              PE_start, logPE_stride, PE_size, pSync);
+
+    /*
+     * the data are pulled and every algorithm ends in a barrier, so
+     * the PEs needn't agree on which one they use
+     */
+    for (i = 0; i < PE_size; i += 1) {
+        sent += source_counts[i];
+    }
+    pick (PE_size, sent / PE_size)->funcmem (target, source,
+            target_counts, target_displs,
+            PE_start, logPE_stride, PE_size, pSync);
+
+    for (i = 0; i < PE_size; i += 1) {
+        target_displs[i] = off;
+        off += target_counts[i];
+    }
+}
+
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
@@ -0,0 +1,170 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include <string.h>
+
+#include "state.h"
+#include "trace.h"
+#include "utils.h"
+#include "atomic.h"
+#include "memalloc.h"
+#include "locality.h"
+
+#include "comms.h"
+
+#include "shmem.h"
+
+#include "barrier-all-impl.h"
+
+/*
+ * Two-level global barrier.  PEs on a host meet their leader through
+ * epoch flags in shared memory (sense-reversing, but with a counter
+ * instead of a single bit), the leaders do a dissemination barrier
+ * over the network, and then release their hosts.  Epochs only ever
+ * go up, so nothing has to be cleared between barriers.
+ *
+ * GASNet's own barrier always spans every node, so it can't be used
+ * for the leaders on their own.
+ *
+ */
+
+typedef struct
+{
+    long arrive;                /* last epoch I reached */
+    long release;               /* last epoch my leader let go */
+    long rounds[LOCALITY_MAX_ROUNDS]; /* leader dissemination */
+} barrier_all_sync_t;
+
+/**
+ * in the symmetric heap, so the other PEs on my host can get at it
+ */
+static barrier_all_sync_t *sync_area = NULL;
+
+static shmemi_locality_t world;
+
+static long epoch = 0;
+
+/**
+ * set up sync area and world layout.  Returns 0 if the barrier can't
+ * be done this way (then nothing is allocated)
+ */
+int
+shmemi_barrier_all_hierarchical_init (void)
+{
+    sync_area =
+        (barrier_all_sync_t *) shmemi_mem_alloc (sizeof (*sync_area));
+    if (EXPR_UNLIKELY (sync_area == (barrier_all_sync_t *) NULL)) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "internal error: cannot allocate symmetric memory"
+                      " for barrier_all");
+        return 0;
+        /* NOT REACHED */
+    }
+    memset (sync_area, 0, sizeof (*sync_area));
+
+    if (! shmemi_locality_build (0, 0, GET_STATE (numpes), 0,
+                                 (long *) sync_area, &world)) {
+        shmemi_mem_free (sync_area);
+        sync_area = NULL;
+        return 0;
+    }
+
+    /* nobody may signal me before I've cleared this */
+    shmemi_comms_barrier_all ();
+
+    shmemi_trace (SHMEM_LOG_BARRIER,
+                  "barrier_all leader %d of %d on %d hosts",
+                  world.locals[0], world.nlocal, world.nnodes);
+
+    return 1;
+}
+
+void
+shmemi_barrier_all_hierarchical (void)
+{
+    int i;
+
+    epoch += 1;
+
+    if (world.lrank == 0) {
+        int dist, r;
+
+        for (i = 1; i < world.nlocal; i += 1) {
+            barrier_all_sync_t *sp =
+                shmemi_locality_ptr (&world, sync_area, i);
+
+            shmem_long_wait_until (&sp->arrive, SHMEM_CMP_GE, epoch);
+        }
+
+        for (r = 0, dist = 1; dist < world.nnodes; r += 1, dist <<= 1) {
+            const int to = world.leaders[(world.node + dist) % world.nnodes];
+
+            shmem_long_p (&sync_area->rounds[r], epoch, to);
+            shmem_long_wait_until (&sync_area->rounds[r],
+                                   SHMEM_CMP_GE, epoch);
+        }
+
+        LOAD_STORE_FENCE ();
+        for (i = 1; i < world.nlocal; i += 1) {
+            barrier_all_sync_t *sp =
+                shmemi_locality_ptr (&world, sync_area, i);
+
+            *((volatile long *) &sp->release) = epoch;
+        }
+    }
+    else {
+        LOAD_STORE_FENCE ();
+        *((volatile long *) &sync_area->arrive) = epoch;
+        shmem_long_wait_until (&sync_area->release, SHMEM_CMP_GE, epoch);
+        LOAD_STORE_FENCE ();
+    }
+}
@@ -53,4 +53,7 @@
 
 extern void shmemi_barrier_all_linear ();
 
+extern int shmemi_barrier_all_hierarchical_init (void);
+extern void shmemi_barrier_all_hierarchical ();
+
 #endif
@@ -56,6 +56,7 @@
 #include "comms.h"
 #include "trace.h"
 #include "utils.h"
+#include "locality.h"
 
 #include "shmem.h"
 
@@ -76,20 +77,34 @@ shmemi_barrier_all_dispatch_init (void)
     char *name = shmemi_comms_getenv ("SHMEM_BARRIER_ALL_ALGORITHM");
 
     if (EXPR_LIKELY (name == (char *) NULL)) {
-        name = default_implementation;
+        name = shmemi_locality_available () ?
+            "hierarchical" : default_implementation;
     }
 
     if (strcmp (name, "linear") == 0) {
         func = shmemi_barrier_all_linear;
     }
+    else if (strcmp (name, "hierarchical") == 0) {
+        if (shmemi_barrier_all_hierarchical_init ()) {
+            func = shmemi_barrier_all_hierarchical;
+        }
+        else {
+            shmemi_trace (SHMEM_LOG_BARRIER,
+                          "PEs don't share memory on-node,"
+                          " falling back to \"%s\"",
+                          default_implementation);
+            name = default_implementation;
+            func = shmemi_barrier_all_linear;
+        }
+    }
     else {
         ;                       /* error */
     }
 
     /*
-     * report which broadcast implementation we set up
+     * report which barrier_all implementation we set up
      */
-    shmemi_trace (SHMEM_LOG_BARRIER, "using broadcast \"%s\"", name);
+    shmemi_trace (SHMEM_LOG_BARRIER, "using barrier_all \"%s\"", name);
 }
 
 /* the rest is what library users see
@@ -0,0 +1,86 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "state.h"
+#include "trace.h"
+#include "locality.h"
+
+#include "shmem.h"
+
+#include "barrier-impl.h"
+
+/*
+ * Two-level barrier: PEs on a host check in with their leader through
+ * shared memory, the leaders do a dissemination barrier among
+ * themselves, then let their hosts go.
+ *
+ */
+
+void
+shmemi_barrier_hierarchical (int PE_start, int logPE_stride, int PE_size,
+                             long *pSync)
+{
+    shmemi_locality_t *lp;
+
+    lp = shmemi_locality_lookup (PE_start, logPE_stride, PE_size,
+                                 0, pSync);
+    if (lp == NULL) {
+        shmemi_barrier_linear (PE_start, logPE_stride, PE_size, pSync);
+        return;
+    }
+
+    shmemi_locality_gather (lp, pSync);
+    if (lp->lrank == 0) {
+        shmemi_locality_leader_barrier (lp, pSync);
+    }
+    shmemi_locality_release (lp, pSync);
+}
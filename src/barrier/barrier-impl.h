@@ -51,7 +51,13 @@
 #ifndef _BARRIER_IMPL_H
 #define _BARRIER_IMPL_H 1
 
+/*
+ * pSync use: linear takes slots 0 and 1, tree 0 and 1, hierarchical
+ * 0 .. SHMEM_BARRIER_SYNC_SIZE - 2 (see locality.h)
+ */
+
 extern void shmemi_barrier_linear ();
 extern void shmemi_barrier_tree ();
+extern void shmemi_barrier_hierarchical ();
 
 #endif
@@ -56,6 +56,8 @@
 #include "comms.h"
 #include "trace.h"
 #include "utils.h"
+#include "locality.h"
+#include "tune.h"
 
 #include "shmem.h"
 
@@ -71,7 +73,16 @@
 
 static char *default_implementation = "linear";
 
-static void (*func) ();
+static const shmemi_tune_algorithm_t algorithms[] = {
+    { "linear", shmemi_barrier_linear, NULL, NULL },
+    { "hierarchical", shmemi_barrier_hierarchical, NULL, NULL },
+#if 0
+    { "tree", shmemi_barrier_tree, NULL, NULL },
+#endif
+};
+
+static int chosen;
+static int use_table = 1;
 
 /*
  * called during initialization of shmem
@@ -84,18 +95,15 @@ shmemi_barrier_dispatch_init (void)
     char *name = shmemi_comms_getenv ("SHMEM_BARRIER_ALGORITHM");
 
     if (EXPR_LIKELY (name == (char *) NULL)) {
-        name = default_implementation;
-    }
-
-    if (strcmp (name, "linear") == 0) {
-        func = shmemi_barrier_linear;
+        name = shmemi_locality_available () ?
+            "hierarchical" : default_implementation;
     }
-#if 0
-    else if (strcmp (name, "tree") == 0) {
-        func = shmemi_barrier_tree;
-    }
-#endif
     else {
+        use_table = 0;          /* user asked for this one */
+    }
+
+    chosen = shmemi_tune_find (algorithms, TUNE_COUNT (algorithms), name);
+    if (EXPR_UNLIKELY (chosen < 0)) {
         shmemi_trace (SHMEM_LOG_FATAL,
                       "unsupported barrier \"%s\"",
                       name);
@@ -103,12 +111,31 @@ shmemi_barrier_dispatch_init (void)
         /* NOT REACHED */
     }
 
+    shmemi_tune_register (TUNE_BARRIER, algorithms, TUNE_COUNT (algorithms));
+
     /*
      * report which barrier implementation we set up
      */
     shmemi_trace (SHMEM_LOG_BARRIER, "using barrier \"%s\"", name);
 }
 
+/**
+ * the tuning table, if any, can pick a better algorithm for this
+ * call's shape
+ */
+static inline const shmemi_tune_algorithm_t *
+pick (int PE_size, size_t nbytes)
+{
+    if (use_table) {
+        const int i = shmemi_tune_lookup (TUNE_BARRIER, PE_size, nbytes);
+
+        if (i >= 0) {
+            return &algorithms[i];
+        }
+    }
+    return &algorithms[chosen];
+}
+
 /*
  * the rest is what library users see
  *
@@ -130,5 +157,5 @@ shmem_barrier (int PE_start, int logPE_stride, int PE_size, long *pSync)
 
     shmem_quiet ();
 
-    func (PE_start, logPE_stride, PE_size, pSync);
+    pick (PE_size, 0)->func32 (PE_start, logPE_stride, PE_size, pSync);
 }
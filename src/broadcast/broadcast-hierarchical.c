@@ -0,0 +1,185 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include <string.h>
+
+#include "state.h"
+#include "trace.h"
+#include "locality.h"
+
+#include "shmem.h"
+
+#include "broadcast-impl.h"
+
+/*
+ * Two-level broadcast: the root leads its host, the leaders pass the
+ * data down a binomial tree with puts, then the other PEs on each host
+ * copy it out of their leader's buffer through shared memory.  Only
+ * one PE per host touches the network.
+ *
+ * Returns 0 if the set isn't worth (or able) doing this way.
+ *
+ */
+
+static int
+broadcast_hierarchical (void *target, const void *source, size_t nbytes,
+                        int PE_root, int PE_start,
+                        int logPE_stride, int PE_size, long *pSync)
+{
+    shmemi_locality_t *lp;
+    const void *from;
+
+    lp = shmemi_locality_lookup (PE_start, logPE_stride, PE_size,
+                                 PE_root, pSync);
+    if (lp == NULL) {
+        return 0;
+    }
+    /* symmetric, so all PEs agree on this */
+    if (shmemi_locality_ptr (lp, target, lp->lrank) == NULL ||
+        shmemi_locality_ptr (lp, source, lp->lrank) == NULL) {
+        return 0;
+    }
+
+    /* the root's host reads from the root's source, others from target */
+    from = (lp->node == 0) ? source : target;
+
+    if (lp->lrank == 0) {
+        int mask;
+
+        if (lp->node > 0) {
+            shmem_long_wait_until (&pSync[LOCALITY_DATA_SLOT],
+                                   SHMEM_CMP_NE, SHMEM_SYNC_VALUE);
+            pSync[LOCALITY_DATA_SLOT] = SHMEM_SYNC_VALUE;
+        }
+
+        /* forward to my children, biggest subtree first */
+        for (mask = 1; mask < lp->nnodes; mask <<= 1) {
+            ;
+        }
+        for (mask >>= 1; mask > lp->node; mask >>= 1) {
+            const int child = lp->node + mask;
+
+            if (child < lp->nnodes) {
+                const int pe = lp->leaders[child];
+
+                shmem_putmem (target, from, nbytes, pe);
+                shmem_fence ();
+                shmem_long_p (&pSync[LOCALITY_DATA_SLOT],
+                              SHMEM_SYNC_VALUE + 1, pe);
+
+                shmemi_trace (SHMEM_LOG_BROADCAST,
+                              "sent %ld bytes to leader PE %d",
+                              nbytes, pe);
+            }
+        }
+
+        /* let the host copy, and keep the buffer until they're done */
+        shmemi_locality_gather (lp, pSync);
+        shmemi_locality_release (lp, pSync);
+        shmemi_locality_gather (lp, pSync);
+        shmemi_locality_release (lp, pSync);
+    }
+    else {
+        shmemi_locality_gather (lp, pSync);
+        shmemi_locality_release (lp, pSync);
+        memcpy (target, shmemi_locality_ptr (lp, from, 0), nbytes);
+        shmemi_locality_gather (lp, pSync);
+        shmemi_locality_release (lp, pSync);
+    }
+
+    return 1;
+}
+
+void
+shmemi_broadcast32_hierarchical (void *target, const void *source,
+                                 size_t nelems,
+                                 int PE_root, int PE_start,
+                                 int logPE_stride, int PE_size, long *pSync)
+{
+    if (! broadcast_hierarchical (target, source, nelems * 4,
+                                  PE_root, PE_start, logPE_stride, PE_size,
+                                  pSync)) {
+        shmemi_broadcast32_tree (target, source, nelems,
+                                 PE_root, PE_start, logPE_stride, PE_size,
+                                 pSync);
+    }
+}
+
+void
+shmemi_broadcast64_hierarchical (void *target, const void *source,
+                                 size_t nelems,
+                                 int PE_root, int PE_start,
+                                 int logPE_stride, int PE_size, long *pSync)
+{
+    if (! broadcast_hierarchical (target, source, nelems * 8,
+                                  PE_root, PE_start, logPE_stride, PE_size,
+                                  pSync)) {
+        shmemi_broadcast64_tree (target, source, nelems,
+                                 PE_root, PE_start, logPE_stride, PE_size,
+                                 pSync);
+    }
+}
+
+void
+shmemi_broadcastmem_hierarchical (void *target, const void *source,
+                                  size_t nbytes,
+                                  int PE_root, int PE_start,
+                                  int logPE_stride, int PE_size, long *pSync)
+{
+    if (! broadcast_hierarchical (target, source, nbytes,
+                                  PE_root, PE_start, logPE_stride, PE_size,
+                                  pSync)) {
+        shmemi_broadcastmem_tree (target, source, nbytes,
+                                  PE_root, PE_start, logPE_stride, PE_size,
+                                  pSync);
+    }
+}
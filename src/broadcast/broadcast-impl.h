@@ -53,8 +53,14 @@
 
 extern void shmemi_broadcast32_linear ();
 extern void shmemi_broadcast64_linear ();
+extern void shmemi_broadcastmem_linear ();
 
 extern void shmemi_broadcast32_tree ();
 extern void shmemi_broadcast64_tree ();
+extern void shmemi_broadcastmem_tree ();
+
+extern void shmemi_broadcast32_hierarchical ();
+extern void shmemi_broadcast64_hierarchical ();
+extern void shmemi_broadcastmem_hierarchical ();
 
 #endif
@@ -67,7 +67,7 @@
                                      int logPE_stride, int PE_size,     \
                                      long *pSync)                       \
     {                                                                   \
-        const int typed_nelems = nelems * Size;                         \
+        const size_t typed_nelems = nelems * Size;                      \
         const int step = 1 << logPE_stride;                             \
         const int root = (PE_root * step) + PE_start;                   \
         const int me = GET_STATE (mype);                                \
@@ -80,3 +80,4 @@
 
 SHMEM_BROADCAST_TYPE (32, 4);
 SHMEM_BROADCAST_TYPE (64, 8);
+SHMEM_BROADCAST_TYPE (mem, 1);
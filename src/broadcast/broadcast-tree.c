@@ -52,10 +52,15 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <stdlib.h>
 #include "state.h"
 #include "trace.h"
+#include "utils.h"
+#include "schedule.h"
 #include "shmem.h"
 
+#include "broadcast-impl.h"
+
 /*
  * Tree based broadcast generates a binary tree with the PEs in the
  * active with PE_root as the root.  The puts happen in a top down
@@ -151,12 +156,47 @@ build_tree (int PE_start, int step, int PE_root, int PE_size,
     }
 }
 
+/*
+ * where I sit in the tree for a given set and root.  This only
+ * changes with those, so it's worked out once and cached.
+ *
+ */
+typedef struct
+{
+    int parent;
+    int child_l;
+    int child_r;
+} tree_t;
+
+static void *
+tree_build (int PE_start, int logPE_stride, int PE_size, int PE_root)
+{
+    const int step = 1 << logPE_stride;
+    tree_t *tp = (tree_t *) malloc (sizeof (*tp));
+
+    if (EXPR_UNLIKELY (tp == (tree_t *) NULL)) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "internal error: cannot allocate memory for"
+                      " broadcast tree");
+        return NULL;
+        /* NOT REACHED */
+    }
+
+    set_2tree (PE_start, step, PE_size,
+               &tp->parent, &tp->child_l, &tp->child_r, GET_STATE (mype));
+    build_tree (PE_start, step, PE_root, PE_size,
+                &tp->parent, &tp->child_l, &tp->child_r, GET_STATE (mype));
+
+    return tp;
+}
+
 void
 shmemi_broadcast32_tree (void *target, const void *source,
                          size_t nlong,
                          int PE_root, int PE_start,
                          int logPE_stride, int PE_size, long *pSync)
 {
+    const tree_t *tp;
     int child_l, child_r, parent;
     const int step = 1 << logPE_stride;
     int my_pe = GET_STATE (mype);
@@ -178,10 +218,13 @@ shmemi_broadcast32_tree (void *target, const void *source,
     target_ptr = (int *) target;
     source_ptr = (int *) source;
 
-    set_2tree (PE_start, step, PE_size, &parent, &child_l, &child_r, my_pe);
+    tp = shmemi_schedule_lookup (SCHEDULE_BROADCAST_TREE,
+                                 PE_start, logPE_stride, PE_size, PE_root,
+                                 tree_build, free);
+    parent = tp->parent;
+    child_l = tp->child_l;
+    child_r = tp->child_r;
     no_children = 0;
-    build_tree (PE_start, step, PE_root, PE_size,
-                &parent, &child_l, &child_r, my_pe);
     shmemi_trace (SHMEM_LOG_BROADCAST,
                   "before broadcast, R_child = %d L_child = %d",
                   child_r, child_l);
@@ -273,3 +316,27 @@ shmemi_broadcast64_tree (void *target, const void *source, size_t nlong,
                              nlong * 2,
                              PE_root, PE_start, logPE_stride, PE_size, pSync);
 }
+
+/*
+ * the tree moves whole ints, so only byte counts that divide up into
+ * them can use it
+ *
+ */
+
+void
+shmemi_broadcastmem_tree (void *target, const void *source, size_t nbytes,
+                          int PE_root, int PE_start,
+                          int logPE_stride, int PE_size, long *pSync)
+{
+    if ((nbytes % sizeof (int)) == 0) {
+        shmemi_broadcast32_tree (target, source,
+                                 nbytes / sizeof (int),
+                                 PE_root, PE_start, logPE_stride, PE_size,
+                                 pSync);
+    }
+    else {
+        shmemi_broadcastmem_linear (target, source, nbytes,
+                                    PE_root, PE_start, logPE_stride, PE_size,
+                                    pSync);
+    }
+}
@@ -56,6 +56,8 @@
 #include "comms.h"
 #include "trace.h"
 #include "utils.h"
+#include "locality.h"
+#include "tune.h"
 
 #include "shmem.h"
 
@@ -63,13 +65,32 @@
 #include "pshmem.h"
 #endif /* HAVE_FEATURE_PSHMEM */
 
+#ifdef HAVE_FEATURE_EXPERIMENTAL
+#include "shmemx.h"
+#ifdef HAVE_FEATURE_PSHMEM
+#include "pshmemx.h"
+#endif /* HAVE_FEATURE_PSHMEM */
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
+
 
 #include "broadcast-impl.h"
 
 static char *default_implementation = "tree";
 
-static void (*func32) ();
-static void (*func64) ();
+static const shmemi_tune_algorithm_t algorithms[] = {
+    { "linear",
+      shmemi_broadcast32_linear, shmemi_broadcast64_linear,
+      shmemi_broadcastmem_linear },
+    { "tree",
+      shmemi_broadcast32_tree, shmemi_broadcast64_tree,
+      shmemi_broadcastmem_tree },
+    { "hierarchical",
+      shmemi_broadcast32_hierarchical, shmemi_broadcast64_hierarchical,
+      shmemi_broadcastmem_hierarchical },
+};
+
+static int chosen;
+static int use_table = 1;
 
 /*
  * called during initialization of shmem
@@ -80,27 +101,49 @@ void
 shmemi_broadcast_dispatch_init (void)
 {
     char *name = shmemi_comms_getenv ("SHMEM_BROADCAST_ALGORITHM");
-    if (EXPR_LIKELY (name == (char *) NULL)) {
-        name = default_implementation;
-    }
 
-    if (strcmp (name, "linear") == 0) {
-        func32 = shmemi_broadcast32_linear;
-        func64 = shmemi_broadcast64_linear;
-    }
-    else if (strcmp (name, "tree") == 0) {
-        func32 = shmemi_broadcast32_tree;
-        func64 = shmemi_broadcast64_tree;
+    if (EXPR_LIKELY (name == (char *) NULL)) {
+        name = shmemi_locality_available () ?
+            "hierarchical" : default_implementation;
     }
     else {
-        ;                       /* error */
+        use_table = 0;          /* user asked for this one */
+    }
+
+    chosen = shmemi_tune_find (algorithms, TUNE_COUNT (algorithms), name);
+    if (EXPR_UNLIKELY (chosen < 0)) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "unsupported broadcast \"%s\"",
+                      name);
+        return;
+        /* NOT REACHED */
     }
+
+    shmemi_tune_register (TUNE_BROADCAST, algorithms, TUNE_COUNT (algorithms));
+
     /*
      * report which broadcast implementation we set up
      */
     shmemi_trace (SHMEM_LOG_BROADCAST, "using broadcast \"%s\"", name);
 }
 
+/**
+ * the tuning table, if any, can pick a better algorithm for this
+ * call's shape
+ */
+static inline const shmemi_tune_algorithm_t *
+pick (int PE_size, size_t nbytes)
+{
+    if (use_table) {
+        const int i = shmemi_tune_lookup (TUNE_BROADCAST, PE_size, nbytes);
+
+        if (i >= 0) {
+            return &algorithms[i];
+        }
+    }
+    return &algorithms[chosen];
+}
+
 /*
  * the rest is what library users see
  *
@@ -123,7 +166,7 @@ shmem_broadcast32 (void *target, const void *source, size_t nelems,
     SYMMETRY_CHECK (pSync, 8, debug_name);
     PE_RANGE_CHECK (PE_start, 5, debug_name);
 
-    func32 (target, source, nelems,
+    pick (PE_size, nelems * 4)->func32 (target, source, nelems,
             PE_root, PE_start, logPE_stride, PE_size, pSync);
 }
 
@@ -144,6 +187,36 @@ shmem_broadcast64 (void *target, const void *source, size_t nelems,
     SYMMETRY_CHECK (pSync, 8, debug_name);
     PE_RANGE_CHECK (PE_start, 5, debug_name);
 
-    func64 (target, source, nelems,
+    pick (PE_size, nelems * 8)->func64 (target, source, nelems,
             PE_root, PE_start, logPE_stride, PE_size, pSync);
 }
+
+#ifdef HAVE_FEATURE_EXPERIMENTAL
+
+#ifdef HAVE_FEATURE_PSHMEM
+#pragma weak shmemx_broadcastmem = pshmemx_broadcastmem
+#define shmemx_broadcastmem pshmemx_broadcastmem
+#endif /* HAVE_FEATURE_PSHMEM */
+
+/**
+ * Broadcast nbytes of untyped data from the root to the other PEs
+ * in the set
+ */
+
+void
+shmemx_broadcastmem (void *target, const void *source, size_t nbytes,
+                     int PE_root, int PE_start, int logPE_stride, int PE_size,
+                     long *pSync)
+{
+    DEBUG_NAME ("shmemx_broadcastmem");
+    INIT_CHECK (debug_name);
+    SYMMETRY_CHECK (target, 1, debug_name);
+    SYMMETRY_CHECK (source, 2, debug_name);
+    SYMMETRY_CHECK (pSync, 8, debug_name);
+    PE_RANGE_CHECK (PE_start, 5, debug_name);
+
+    pick (PE_size, nbytes)->funcmem (target, source, nbytes,
+            PE_root, PE_start, logPE_stride, PE_size, pSync);
+}
+
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
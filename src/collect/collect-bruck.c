@@ -0,0 +1,237 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include <sys/types.h>
+#include <string.h>
+
+#include "state.h"
+#include "putget.h"
+#include "trace.h"
+#include "utils.h"
+
+#include "comms/comms.h"
+
+#include "shmem.h"
+
+#include "barrier-impl.h"
+#include "collect-impl.h"
+
+/**
+ * collect puts nelems (can vary from PE to PE) from source on each
+ * PE in the set to target on all PEs in the set.  source -> target is
+ * done in PE order.
+ *
+ * Offsets are found with a log-depth scan: in round k every PE sends
+ * its running prefix sum 2^k PEs to the right and its running suffix
+ * sum 2^k PEs to the left.  After ceil(log2(PE_size)) rounds each PE
+ * knows its own offset and the total length without anyone waiting on
+ * a wavefront.
+ *
+ * Data then moves Bruck-style: in round k each PE pulls the run of
+ * blocks already held by the PE 2^k to its right (wrapping around the
+ * set), so the number of blocks held doubles every round.
+ *
+ * pSync[0] and pSync[1] belong to the closing linear barrier, the rest
+ * is carved up into one slot per round for prefix, suffix and run
+ * length.  Other barriers may use those slots too (see locality.h), so
+ * the linear one is always used here.  Everything is put back to
+ * SHMEM_SYNC_VALUE before the barrier.
+ *
+ */
+
+#define COLLECT_FIRST_SLOT 2
+#define COLLECT_MAX_ROUNDS                                              \
+    ((SHMEM_COLLECT_SYNC_SIZE - COLLECT_FIRST_SLOT) / 3)
+
+static inline int
+vpe_to_pe (int vpe, int PE_start, int logPE_stride)
+{
+    return PE_start + (vpe << logPE_stride);
+}
+
+/*
+ * consume a value put into a sync slot and re-arm it
+ */
+static inline long
+take_slot (long *slot)
+{
+    long v;
+
+    shmem_long_wait (slot, SHMEM_SYNC_VALUE);
+    v = *slot;
+    *slot = SHMEM_SYNC_VALUE;
+
+    return v;
+}
+
+static void
+collect_bruck (void *target, const void *source, size_t nelems,
+               size_t bytes,
+               int PE_start, int logPE_stride, int PE_size, long *pSync)
+{
+    const int me = GET_STATE (mype);
+    const int vme = (me - PE_start) >> logPE_stride;
+    long *pre_slot = &(pSync[COLLECT_FIRST_SLOT]);
+    long *suf_slot = pre_slot + COLLECT_MAX_ROUNDS;
+    long *len_slot = suf_slot + COLLECT_MAX_ROUNDS;
+    char *t = (char *) target;
+    long pre = (long) nelems;
+    long suf = (long) nelems;
+    long off;
+    long total;
+    long have;
+    int dist;
+    int round;
+
+    /* parallel prefix (and suffix) of the per-PE lengths */
+    for (round = 0, dist = 1; dist < PE_size; round += 1, dist <<= 1) {
+        const int right = vme + dist < PE_size;
+        const int left = vme - dist >= 0;
+
+        if (right) {
+            shmem_long_p (&pre_slot[round], pre,
+                          vpe_to_pe (vme + dist, PE_start, logPE_stride));
+        }
+        if (left) {
+            shmem_long_p (&suf_slot[round], suf,
+                          vpe_to_pe (vme - dist, PE_start, logPE_stride));
+        }
+        if (left) {
+            pre += take_slot (&pre_slot[round]);
+        }
+        if (right) {
+            suf += take_slot (&suf_slot[round]);
+        }
+    }
+
+    off = pre - (long) nelems;
+    total = pre + suf - (long) nelems;
+
+    shmemi_trace (SHMEM_LOG_COLLECT,
+                  "nelems = %ld, offset = %ld, total = %ld",
+                  nelems, off, total);
+
+    memcpy (t + off * bytes, source, nelems * bytes);
+
+    if (total == 0) {
+        goto done;
+    }
+
+    /* I hold [off, off + have), wrapping modulo total */
+    have = (long) nelems;
+
+    for (round = 0, dist = 1; dist < PE_size; round += 1, dist <<= 1) {
+        const int to =
+            vpe_to_pe ((vme - dist + PE_size) % PE_size,
+                       PE_start, logPE_stride);
+        const int from =
+            vpe_to_pe ((vme + dist) % PE_size, PE_start, logPE_stride);
+        const long start = (off + have) % total;
+        long want;
+
+        shmem_long_p (&len_slot[round], have, to);
+
+        want = take_slot (&len_slot[round]);
+        if (want > total - have) {
+            want = total - have;
+        }
+
+        if (start + want <= total) {
+            shmem_getmem (t + start * bytes, t + start * bytes,
+                          want * bytes, from);
+        }
+        else {
+            const long first = total - start;
+
+            shmem_getmem (t + start * bytes, t + start * bytes,
+                          first * bytes, from);
+            shmem_getmem (t, t, (want - first) * bytes, from);
+        }
+
+        shmemi_trace (SHMEM_LOG_COLLECT,
+                      "round %d: got %ld from %d at %ld",
+                      round, want, from, start);
+
+        have += want;
+    }
+
+ done:
+    /*
+     * a slower PE may still be waiting on its round slots, so this
+     * can't be a barrier that uses them too
+     */
+    shmemi_barrier_linear (PE_start, logPE_stride, PE_size, pSync);
+}
+
+/*
+ * only fall back when there are more rounds than sync slots
+ */
+
+#define SHMEM_COLLECT(Bits, Bytes)                                      \
+    void                                                                \
+    shmemi_collect##Bits##_bruck(void *target, const void *source,      \
+                                 size_t nelems,                         \
+                                 int PE_start, int logPE_stride, int PE_size, \
+                                 long *pSync)                           \
+    {                                                                   \
+        if (EXPR_UNLIKELY(PE_size > (1 << COLLECT_MAX_ROUNDS))) {       \
+            shmemi_collect##Bits##_linear(target, source, nelems,       \
+                                          PE_start, logPE_stride, PE_size, \
+                                          pSync);                       \
+            return;                                                     \
+        }                                                               \
+        collect_bruck(target, source, nelems, Bytes,                    \
+                      PE_start, logPE_stride, PE_size, pSync);          \
+    }
+
+SHMEM_COLLECT (32, 4);
+SHMEM_COLLECT (64, 8);
@@ -54,4 +54,7 @@
 extern void shmemi_collect32_linear ();
 extern void shmemi_collect64_linear ();
 
+extern void shmemi_collect32_bruck ();
+extern void shmemi_collect64_bruck ();
+
 #endif
@@ -56,6 +56,7 @@
 #include "comms.h"
 #include "trace.h"
 #include "utils.h"
+#include "tune.h"
 
 #include "shmem.h"
 
@@ -65,10 +66,20 @@
 #include "pshmem.h"
 #endif /* HAVE_FEATURE_PSHMEM */
 
-static char *default_implementation = "linear";
+static char *default_implementation = "bruck";
 
-static void (*func32) ();
-static void (*func64) ();
+static const shmemi_tune_algorithm_t algorithms[] = {
+    { "linear", shmemi_collect32_linear, shmemi_collect64_linear, NULL },
+    { "bruck", shmemi_collect32_bruck, shmemi_collect64_bruck, NULL },
+};
+
+static int chosen;
+static int use_table = 1;
+
+/*
+ * called during initialization of shmem
+ *
+ */
 
 void
 shmemi_collect_dispatch_init (void)
@@ -78,19 +89,42 @@ shmemi_collect_dispatch_init (void)
     if (EXPR_LIKELY (name == (char *) NULL)) {
         name = default_implementation;
     }
-
-    if (strcmp (name, "linear") == 0) {
-        func32 = shmemi_collect32_linear;
-        func64 = shmemi_collect64_linear;
-    }
     else {
-        ;                       /* error */
+        use_table = 0;          /* user asked for this one */
+    }
+
+    chosen = shmemi_tune_find (algorithms, TUNE_COUNT (algorithms), name);
+    if (EXPR_UNLIKELY (chosen < 0)) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "unsupported collect \"%s\"",
+                      name);
+        return;
+        /* NOT REACHED */
     }
 
+    shmemi_tune_register (TUNE_COLLECT, algorithms, TUNE_COUNT (algorithms));
+
     /*
-     * report which implementation we set up
+     * report which collect implementation we set up
      */
-    shmemi_trace (SHMEM_LOG_BROADCAST, "using collect \"%s\"", name);
+    shmemi_trace (SHMEM_LOG_COLLECT, "using collect \"%s\"", name);
+}
+
+/**
+ * the tuning table, if any, can pick a better algorithm for this
+ * call's shape
+ */
+static inline const shmemi_tune_algorithm_t *
+pick (int PE_size, size_t nbytes)
+{
+    if (use_table) {
+        const int i = shmemi_tune_lookup (TUNE_COLLECT, PE_size, nbytes);
+
+        if (i >= 0) {
+            return &algorithms[i];
+        }
+    }
+    return &algorithms[chosen];
 }
 
 /*
@@ -120,7 +154,9 @@ shmem_collect32 (void *target, const void *source, size_t nelems,
     PE_RANGE_CHECK (PE_start, 4, debug_name);
     /* PE_RANGE_CHECK (PE_size, 6, debug_name); */
 
-    func32 (target, source, nelems, PE_start, logPE_stride, PE_size, pSync);
+    /* PEs may contribute different amounts, so only PE_size counts */
+    pick (PE_size, 0)->func32 (target, source, nelems,
+                               PE_start, logPE_stride, PE_size, pSync);
 }
 
 
@@ -146,5 +182,6 @@ shmem_collect64 (void *target, const void *source, size_t nelems,
     PE_RANGE_CHECK (PE_start, 4, debug_name);
     /* PE_RANGE_CHECK (PE_size, 6, debug_name); */
 
-    func64 (target, source, nelems, PE_start, logPE_stride, PE_size, pSync);
+    pick (PE_size, 0)->func64 (target, source, nelems,
+                               PE_start, logPE_stride, PE_size, pSync);
 }
@@ -65,6 +65,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <strings.h>
 #include <sys/mman.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -79,12 +80,18 @@
 #include "exe.h"
 #include "globalvar.h"
 #include "clock.h"
+#include "locality.h"
+#include "numa.h"
+#include "schedule.h"
 
 #include "barrier.h"
 #include "barrier-all.h"
 #include "broadcast.h"
 #include "collect.h"
 #include "fcollect.h"
+#include "alltoall.h"
+#include "reduce.h"
+#include "nbcoll.h"
 
 #include "trace.h"
 #include "utils.h"
@@ -218,13 +225,31 @@ place_init (void)
         SET_STATE (locp[i], gnip[i].host);
     }
 
-    free (gnip);
+    /*
+     * keep the full node info around: it tells us which PEs share a
+     * PSHM supernode, and how to map their segments
+     */
+    nodeinfo_table = gnip;
 
     /*
      * TODO: free up the neighborhood table on finalize
      */
 }
 
+/**
+ * can PEs "a" and "b" see each other's heaps as plain memory?  This
+ * needs GASNet's PSHM support and the heap inside the GASNet segment.
+ */
+static inline bool
+shmemi_comms_shared_memory (int a, int b)
+{
+#if defined(GASNET_PSHM) && defined(HAVE_MANAGED_SEGMENTS)
+    return nodeinfo_table[a].supernode == nodeinfo_table[b].supernode;
+#else
+    return false;
+#endif /* GASNET_PSHM && HAVE_MANAGED_SEGMENTS */
+}
+
 /* end: locality query */
 
 /* service.c */
@@ -300,6 +325,9 @@ start_service (void *unused)
 {
     do {
         gasnet_AMPoll ();
+#if defined(HAVE_FEATURE_EXPERIMENTAL) && defined(GASNET_PAR)
+        shmemi_nbcoll_poll ();  /* move non-blocking collectives on */
+#endif /* HAVE_FEATURE_EXPERIMENTAL && GASNET_PAR */
         pthread_yield ();
         nanosleep (&delayspec, NULL);   /* back off */
     }
@@ -308,6 +336,16 @@ start_service (void *unused)
     return (shmem_thread_return_t) 0;
 }
 
+/**
+ * let the network make progress while the caller spins on local
+ * memory
+ */
+static inline void
+shmemi_comms_poll (void)
+{
+    gasnet_AMPoll ();
+}
+
 /**
  * assume initially we need to manage progress ourselves
  */
@@ -419,6 +457,20 @@ shmemi_service_init (void)
     }
 }
 
+/**
+ * keep the servicer on this PE's NUMA node
+ */
+
+static inline void
+shmemi_service_place (void)
+{
+#if defined(SHMEM_USE_PTHREADS)
+    if ((!use_conduit_thread) && thread_starter) {
+        shmemi_numa_place_thread (thr);
+    }
+#endif /* SHMEM_USE_PTHREADS */
+}
+
 /**
  * stop the servicer
  */
@@ -491,6 +543,28 @@ shmemi_comms_barrier_all (void)
     barcount += 1;
 }
 
+/**
+ * global barrier that also tells whether every PE passed the same
+ * "value": GASNet reports a mismatched barrier id to everyone.  Used
+ * to check things are the same everywhere without a collective.
+ */
+
+static inline int
+shmemi_comms_barrier_all_same (int value)
+{
+    int s;
+
+    gasnet_barrier_notify (value, barflag);
+    s = gasnet_barrier_wait (value, barflag);
+    if (s == GASNET_ERR_BARRIER_MISMATCH) {
+        return 0;
+        /* NOT REACHED */
+    }
+    GASNET_SAFE (s);
+
+    return 1;
+}
+
 /**
  * gasnet put model: this is just for testing different put
  * emulations; generally we want the nbi routines to get performance.
@@ -548,10 +622,10 @@ shmemi_comms_barrier_all (void)
  */
 
 /**
- * where the symmetric memory lives on the given PE
+ * where segment "s" of the symmetric memory lives on the given PE
  */
-#define SHMEM_SYMMETRIC_HEAP_BASE(p) (seginfo_table[(p)].addr)
-#define SHMEM_SYMMETRIC_HEAP_SIZE(p) (seginfo_table[(p)].size)
+#define SHMEM_SYMMETRIC_HEAP_SEG(s, p) \
+    (seginfo_table[(s) * GET_STATE (numpes) + (p)])
 
 /**
  * translate my "dest" to corresponding address on PE "pe"
@@ -559,29 +633,67 @@ shmemi_comms_barrier_all (void)
 static inline void *
 shmemi_symmetric_addr_lookup (void *dest, int pe)
 {
+    /* heap at the same address everywhere: nothing to translate */
+    if (heap_same_address &&
+        ((size_t) dest - (size_t) seginfo_table[0].addr <
+         seginfo_table[0].size)) {
+        return dest;
+    }
+
     /* globals are in same place everywhere */
     if (shmemi_symmetric_is_globalvar (dest)) {
         return dest;
     }
 
-    /* symmetric if inside of heap */
+    /* symmetric if inside one of my heap segments */
     {
-        int me = GET_STATE (mype);
-        size_t al = (size_t) SHMEM_SYMMETRIC_HEAP_BASE (me); /* lower bound */
-        size_t aao = (size_t) dest; /* my addr as offset */
-        long offset = aao - al;
+        const int me = GET_STATE (mype);
+        const size_t aao = (size_t) dest;   /* my addr as offset */
+        int lo = 0;
+        int hi = heap_nsegs - 1;
+
+        while (lo <= hi) {
+            const int mid = (lo + hi) / 2;
+            const int s = heap_seg_order[mid];
+            const size_t al = (size_t) SHMEM_SYMMETRIC_HEAP_SEG (s, me).addr;
+
+            if (aao < al) {
+                hi = mid - 1;
+            }
+            else if (aao - al >= SHMEM_SYMMETRIC_HEAP_SEG (s, me).size) {
+                lo = mid + 1;
+            }
+            else {
+                /* and where it is in the remote heap */
+                return SHMEM_SYMMETRIC_HEAP_SEG (s, pe).addr + (aao - al);
+            }
+        }
 
         /* trap addresses outside the heap */
-        if (offset < 0) {
-            return NULL;
-        }
-        if (offset > SHMEM_SYMMETRIC_HEAP_SIZE (me)) {
-            return NULL;
-        }
+        return NULL;
+    }
+}
+
+/**
+ * translate my symmetric heap address "addr" to a pointer I can load
+ * from and store to directly, through the PSHM mapping of PE "pe"'s
+ * segment.  NULL if "pe" is not in my supernode, or "addr" is not in
+ * the heap (globals are outside the GASNet segment)
+ */
+static inline void *
+shmemi_comms_local_ptr (void *addr, int pe)
+{
+#if defined(GASNET_PSHM) && defined(HAVE_MANAGED_SEGMENTS)
+    if (shmemi_comms_shared_memory (GET_STATE (mype), pe) &&
+        ! shmemi_symmetric_is_globalvar (addr)) {
+        void *rp = shmemi_symmetric_addr_lookup (addr, pe);
 
-        /* and where it is in the remote heap */
-        return SHMEM_SYMMETRIC_HEAP_BASE (pe) + offset;
+        if (rp != NULL) {
+            return (void *) ((uintptr_t) rp + nodeinfo_table[pe].offset);
+        }
     }
+#endif /* GASNET_PSHM && HAVE_MANAGED_SEGMENTS */
+    return NULL;
 }
 
 /*
@@ -600,7 +712,6 @@ shmemi_symmetric_addr_lookup (void *dest, int pe)
 enum
 {
     GASNET_HANDLER_setup_out = 128,
-    GASNET_HANDLER_setup_bak,
 
     AMO_HANDLER_DEF (swap, int),
     AMO_HANDLER_DEF (swap, long),
@@ -649,6 +760,11 @@ enum
     GASNET_HANDLER_globalvar_get_out,
     GASNET_HANDLER_globalvar_get_bak,
 
+    GASNET_HANDLER_strided_put_out,
+    GASNET_HANDLER_strided_put_bak,
+    GASNET_HANDLER_strided_get_out,
+    GASNET_HANDLER_strided_get_bak,
+
     GASNET_HANDLER_globalexit_out
     /* no reply partner for global_exit */
 };
@@ -663,44 +779,144 @@ shmemi_comms_getenv (const char *name)
     return gasnet_getenv (name);
 }
 
+/**
+ * which pages the heap should use, from environment setting
+ */
+static inline void
+parse_hugepages (void)
+{
+    char *hp_str = shmemi_comms_getenv ("SHMEM_SYMMETRIC_HEAP_HUGEPAGES");
+
+    if (EXPR_LIKELY (hp_str == (char *) NULL)) {
+        heap_hugepages = HUGEPAGES_NONE;
+    }
+    else if (strcasecmp (hp_str, "2M") == 0) {
+        heap_hugepages = HUGEPAGES_2M;
+    }
+    else if (strcasecmp (hp_str, "1G") == 0) {
+        heap_hugepages = HUGEPAGES_1G;
+    }
+    else if (strcasecmp (hp_str, "thp") == 0) {
+        heap_hugepages = HUGEPAGES_THP;
+    }
+    else {
+        comms_bailout ("Unusable symmetric heap huge page setting \"%s\"",
+                       hp_str);
+        /* NOT REACHED */
+    }
+    heap_hugepages_asked = heap_hugepages;
+}
+
+/**
+ * the page size the heap gets rounded to.  Transparent huge pages
+ * are PMD-sized, which is 2M on the usual platforms.
+ */
+static inline size_t
+hugepage_size (heap_hugepages_t h)
+{
+    switch (h) {
+    case HUGEPAGES_2M:
+    case HUGEPAGES_THP:
+        return 2UL << 20;
+    case HUGEPAGES_1G:
+        return 1UL << 30;
+    default:
+        return GASNET_PAGESIZE;
+    }
+}
+
 /**
  * work out how big the symmetric segment areas should be.
  *
  * Either from environment setting, or default value from
- * implementation
+ * implementation, rounded to the page size in use
  */
 static inline size_t
 shmemi_comms_get_segment_size (void)
 {
     char *mlss_str = shmemi_comms_getenv ("SHMEM_SYMMETRIC_HEAP_SIZE");
+    size_t pagesize;
     size_t retval;
     int ok;
 
+    parse_hugepages ();
+    pagesize = hugepage_size (heap_hugepages_asked);
+
     if (EXPR_LIKELY (mlss_str == (char *) NULL)) {
 #ifdef HAVE_MANAGED_SEGMENTS
-        return (size_t) gasnet_getMaxLocalSegmentSize ();
+        retval = (size_t) gasnet_getMaxLocalSegmentSize ();
+
+        /* can't go over the maximum, so round down */
+        if (retval >= pagesize) {
+            retval -= retval % pagesize;
+        }
+        return retval;
 #else
-        return DEFAULT_HEAP_SIZE;
+        retval = DEFAULT_HEAP_SIZE;
 #endif
     }
+    else {
+        shmemi_parse_size (mlss_str, &retval, &ok);
+        if (EXPR_UNLIKELY (! ok)) {
+            comms_bailout ("Unusable symmetric heap size \"%s\"", mlss_str);
+            /* NOT REACHED */
+        }
+    }
 
-    shmemi_parse_size (mlss_str, &retval, &ok);
-    if (EXPR_LIKELY (ok)) {
-        /* make sure aligned to page size multiples */
-        const size_t mod = retval % GASNET_PAGESIZE;
+    /* make sure aligned to page size multiples */
+    {
+        const size_t mod = retval % pagesize;
 
         if (EXPR_UNLIKELY (mod != 0)) {
-            const size_t div = retval / GASNET_PAGESIZE;
-            retval = (div + 1) * GASNET_PAGESIZE;
+            const size_t div = retval / pagesize;
+            retval = (div + 1) * pagesize;
         }
+    }
 
-        return retval;
+    return retval;
+}
+
+/**
+ * how far the symmetric heap may grow, from environment setting,
+ * rounded to the page size in use.  0 if it has to stay at its
+ * initial size.
+ */
+static inline size_t
+shmemi_comms_get_segment_max_size (void)
+{
+    char *max_str = shmemi_comms_getenv ("SHMEM_SYMMETRIC_HEAP_MAX_SIZE");
+    const size_t pagesize = hugepage_size (heap_hugepages_asked);
+    size_t retval;
+    int ok;
+
+    if (EXPR_LIKELY (max_str == (char *) NULL)) {
+        return 0;
+    }
+
+    shmemi_parse_size (max_str, &retval, &ok);
+    if (EXPR_UNLIKELY (! ok)) {
+        comms_bailout ("Unusable symmetric heap maximum size \"%s\"",
+                       max_str);
         /* NOT REACHED */
     }
 
-    comms_bailout ("Unusable symmetric heap size \"%s\"", mlss_str);
-    /* NOT REACHED */
-    return 0;
+    if (retval % pagesize != 0) {
+        retval += pagesize - (retval % pagesize);
+    }
+
+#ifdef HAVE_MANAGED_SEGMENTS
+    /* grows inside the segment, which can't go over the maximum */
+    {
+        size_t limit = (size_t) gasnet_getMaxLocalSegmentSize ();
+
+        limit -= limit % pagesize;
+        if (retval > limit) {
+            retval = limit;
+        }
+    }
+#endif /* HAVE_MANAGED_SEGMENTS */
+
+    return (retval > GET_STATE (heapsize)) ? retval : 0;
 }
 
 /**
@@ -709,51 +925,358 @@ shmemi_comms_get_segment_size (void)
  * initialize the symmetric segments.
  *
  * In the gasnet fast/large models, use the attached segments and
- * manage address translations through the segment table
+ * manage address translations through the segment table.  A heap
+ * that can grow attaches its maximum size, and grows into the rest
+ * of the segment.
  *
  * In the everything model, we allocate on our own heap and send out
- * the addresses with active messages
+ * the addresses with active messages.  A heap that grows allocates
+ * and sends out another segment.  If asked, everyone tries to put
+ * the heap where PE 0 has it, reserving all it can grow into, so the
+ * addresses need no translation.
  */
 
 #if ! defined(HAVE_MANAGED_SEGMENTS)
 
 /**
- * unpack buf from sender PE and store seg info locally.  Ack. receipt.
+ * entries follow the header in a segment exchange message, suitably
+ * aligned
+ */
+#define SEG_ANNOUNCE_HEADER_SIZE                                    \
+    ((sizeof (seg_announce_t) + sizeof (void *) - 1) &              \
+     ~(sizeof (void *) - 1))
+
+#define SEG_ANNOUNCE_INFO(Sap)                                      \
+    ((gasnet_seginfo_t *) ((char *) (Sap) + SEG_ANNOUNCE_HEADER_SIZE))
+
+/**
+ * unpack a run of segment entries into this exchange's staging table,
+ * and count them for their round
  */
 static void
 handler_segsetup_out (gasnet_token_t token, void *buf, size_t bufsiz)
 {
-    gasnet_node_t src_pe;
-    gasnet_seginfo_t *gsp = (gasnet_seginfo_t *) buf;
+    const int npes = GET_STATE (numpes);
+    seg_announce_t *sap = (seg_announce_t *) buf;
+    gasnet_seginfo_t *stage = seg_setup_stage[sap->call & 1];
+    gasnet_seginfo_t *info = SEG_ANNOUNCE_INFO (sap);
+    int i;
 
-    /*
-     * no lock here: each PE writes exactly once to its own array index,
-     * and only to that...
-     */
+    /* each entry arrives exactly once per exchange */
+    for (i = 0; i < sap->count; i += 1) {
+        stage[(sap->first + i) % npes] = info[i];
+    }
+    LOAD_STORE_FENCE ();
 
-    /* gasnet_hsl_lock(& setup_out_lock); */
+    gasnet_hsl_lock (&setup_out_lock);
 
-    GASNET_SAFE (gasnet_AMGetMsgSource (token, &src_pe));
+    seg_setup_received[sap->call & 1][sap->round] += sap->count;
 
-    seginfo_table[(int) src_pe].addr = gsp->addr;
-    seginfo_table[(int) src_pe].size = gsp->size;
+    gasnet_hsl_unlock (&setup_out_lock);
+}
 
-    /* gasnet_hsl_unlock(& setup_out_lock); */
+#endif /* ! HAVE_MANAGED_SEGMENTS */
 
-    gasnet_AMReplyMedium0 (token, GASNET_HANDLER_setup_bak, (void *) NULL, 0);
+/**
+ * ask for transparent huge pages on [ADDR, ADDR + SIZE).  Returns
+ * non-zero if the kernel took the advice.
+ */
+static inline int
+hugepage_advise (void *addr, size_t size)
+{
+#ifdef MADV_HUGEPAGE
+    if (madvise (addr, size, MADV_HUGEPAGE) == 0) {
+        return 1;
+    }
+    shmemi_trace (SHMEM_LOG_INIT,
+                  "transparent huge pages unavailable (%s)",
+                  strerror (errno));
+#else
+    shmemi_trace (SHMEM_LOG_INIT,
+                  "transparent huge pages not supported on this platform");
+#endif /* MADV_HUGEPAGE */
+    return 0;
 }
 
 /**
- * record receipt ack.  We only need to count the number of replies
+ * most segments the heap can be made of
  */
-static void
-handler_segsetup_bak (gasnet_token_t token, void *buf, size_t bufsiz)
+static inline int
+heap_max_segs (void)
 {
-    gasnet_hsl_lock (&setup_bak_lock);
+#ifdef HAVE_MANAGED_SEGMENTS
+    return 1;
+#else
+    return (heap_max_size > 0) ? MEM_MAX_POOLS : 1;
+#endif /* HAVE_MANAGED_SEGMENTS */
+}
 
-    seg_setup_replies_received += 1;
+/**
+ * add segment "s" to my address-ordered list
+ */
+static inline void
+heap_seg_insert (int s)
+{
+    const int me = GET_STATE (mype);
+    const uintptr_t a = (uintptr_t) SHMEM_SYMMETRIC_HEAP_SEG (s, me).addr;
+    int i;
 
-    gasnet_hsl_unlock (&setup_bak_lock);
+    for (i = heap_nsegs; i > 0; i -= 1) {
+        const int prev = heap_seg_order[i - 1];
+
+        if ((uintptr_t) SHMEM_SYMMETRIC_HEAP_SEG (prev, me).addr < a) {
+            break;
+        }
+        heap_seg_order[i] = prev;
+    }
+    heap_seg_order[i] = s;
+    heap_nsegs += 1;
+}
+
+/**
+ * non-zero if segment "s" is at the same address on all PEs
+ */
+static inline int
+heap_seg_same_address (int s)
+{
+    const void *addr = SHMEM_SYMMETRIC_HEAP_SEG (s, 0).addr;
+    int pe;
+
+    for (pe = 1; pe < GET_STATE (numpes); pe += 1) {
+        if (SHMEM_SYMMETRIC_HEAP_SEG (s, pe).addr != addr) {
+            return 0;
+            /* NOT REACHED */
+        }
+    }
+    return 1;
+}
+
+#if ! defined(HAVE_MANAGED_SEGMENTS)
+
+#ifdef MAP_HUGETLB
+/**
+ * mmap flags for explicit huge pages of the size asked for
+ */
+static inline int
+heap_map_flags (void)
+{
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+
+#ifdef MAP_HUGE_SHIFT
+    flags |= ((heap_hugepages == HUGEPAGES_2M) ? 21 : 30) << MAP_HUGE_SHIFT;
+#endif /* MAP_HUGE_SHIFT */
+
+    return flags;
+}
+#endif /* MAP_HUGETLB */
+
+/**
+ * allocate segment "s" of the heap, "size" bytes, from explicit huge
+ * pages if they were asked for and the system has them, otherwise
+ * malloc'ed and (if asked) advised to use transparent huge pages.
+ * Returns the page size the segment ended up with, 0 meaning
+ * transparent huge pages.
+ */
+static inline size_t
+heap_alloc (int s, size_t size)
+{
+    gasnet_seginfo_t *gsp = &SHMEM_SYMMETRIC_HEAP_SEG (s, GET_STATE (mype));
+    size_t align = MEM_SEGMENT_ALIGN;
+    int pm_r;
+
+    gsp->size = size;
+
+#ifdef MAP_HUGETLB
+    if ((heap_hugepages == HUGEPAGES_2M) ||
+        (heap_hugepages == HUGEPAGES_1G)) {
+        const size_t pagesize = hugepage_size (heap_hugepages);
+        void *p;
+
+        p = mmap (NULL, size, PROT_READ | PROT_WRITE, heap_map_flags (),
+                  -1, 0);
+        if (EXPR_LIKELY (p != MAP_FAILED)) {
+            gsp->addr = p;
+            great_big_heap_mapped[s] = size;
+            return pagesize;
+            /* NOT REACHED */
+        }
+
+        shmemi_trace (SHMEM_LOG_INIT,
+                      "unable to map %ld bytes of huge pages (%s),"
+                      " trying transparent huge pages",
+                      size, strerror (errno));
+        heap_hugepages = HUGEPAGES_THP;
+    }
+#endif /* MAP_HUGETLB */
+
+    if (heap_hugepages != HUGEPAGES_NONE) {
+        /* the THP ranges have to be aligned to get used */
+        heap_hugepages = HUGEPAGES_THP;
+        align = hugepage_size (HUGEPAGES_THP);
+    }
+    if (align < GASNET_PAGESIZE) {
+        align = GASNET_PAGESIZE;
+    }
+
+    /* allocate the segment - has to be pagesize aligned */
+    pm_r = posix_memalign (&gsp->addr, align, size);
+    if (EXPR_UNLIKELY (pm_r != 0)) {
+        comms_bailout ("unable to allocate symmetric heap (%s)",
+                       strerror (pm_r)
+            );
+        /* NOT REACHED */
+    }
+    great_big_heap_mapped[s] = 0;
+
+    if ((heap_hugepages == HUGEPAGES_THP) &&
+        hugepage_advise (gsp->addr, size)) {
+        return 0;
+        /* NOT REACHED */
+    }
+    return GASNET_PAGESIZE;
+}
+
+/**
+ * send my segment "s" to everyone else, and wait until I have
+ * everyone else's.
+ *
+ * This is a dissemination allgather: in round k, with d = 2^k, I pass
+ * the entries I have for PEs me .. me+d-1 to PE me-d, and get those
+ * for PEs me+d .. me+2d-1 from PE me+d.  So log2(npes) rounds instead
+ * of a message from every PE to every other.
+ */
+static inline void
+heap_seg_announce (int s)
+{
+    const int me = GET_STATE (mype);
+    const int npes = GET_STATE (numpes);
+    const int call = seg_setup_calls;
+    const int which = call & 1;
+    gasnet_seginfo_t *stage = seg_setup_stage[which];
+    const size_t max_req = gasnet_AMMaxMedium ();
+    const int per_msg =
+        (int) ((max_req - SEG_ANNOUNCE_HEADER_SIZE) /
+               sizeof (gasnet_seginfo_t));
+    seg_announce_t *sap;
+    int round;
+    int dist;
+    int pe;
+
+    seg_setup_calls += 1;
+
+    stage[me] = SHMEM_SYMMETRIC_HEAP_SEG (s, me);
+
+    sap = (seg_announce_t *) malloc (max_req);
+    if (EXPR_UNLIKELY (sap == (seg_announce_t *) NULL)) {
+        comms_bailout ("could not allocate segment exchange buffer (%s)",
+                       strerror (errno)
+                       );
+        /* NOT REACHED */
+    }
+
+    for (round = 0, dist = 1; dist < npes; round += 1, dist <<= 1) {
+        const int to = (me - dist + npes) % npes;
+        const int count = (dist < npes - dist) ? dist : npes - dist;
+        int done;
+        int n;
+
+        for (done = 0; done < count; done += n) {
+            gasnet_seginfo_t *info = SEG_ANNOUNCE_INFO (sap);
+            int i;
+
+            n = count - done;
+            if (n > per_msg) {
+                n = per_msg;
+            }
+
+            sap->seg = s;
+            sap->call = call;
+            sap->round = round;
+            sap->first = (me + done) % npes;
+            sap->count = n;
+            for (i = 0; i < n; i += 1) {
+                info[i] = stage[(sap->first + i) % npes];
+            }
+
+            /* payload is copied out by GASNet, so buffer can be reused */
+            gasnet_AMRequestMedium0 (to, GASNET_HANDLER_setup_out,
+                                     sap, SEG_ANNOUNCE_HEADER_SIZE +
+                                     n * sizeof (gasnet_seginfo_t)
+                );
+        }
+
+        /* the same number come to me, and I pass them on next round */
+        GASNET_BLOCKUNTIL (seg_setup_received[which][round] >= count);
+    }
+
+    free (sap);
+
+    for (pe = 0; pe < npes; pe += 1) {
+        SHMEM_SYMMETRIC_HEAP_SEG (s, pe) = stage[pe];
+    }
+
+    /*
+     * nobody can start the exchange after next until they have my
+     * entry from the next one, so these are free to reset
+     */
+    for (round = 0; round < SEG_SETUP_MAX_ROUNDS; round += 1) {
+        seg_setup_received[which][round] = 0;
+    }
+}
+
+/**
+ * try to move my segment 0 to where PE 0 has it, so the heap can be
+ * used without translation.  Returns non-zero if it moved.
+ */
+static inline int
+heap_move_to_pe0 (void)
+{
+    gasnet_seginfo_t *gsp = &SHMEM_SYMMETRIC_HEAP_SEG (0, GET_STATE (mype));
+    void *want = SHMEM_SYMMETRIC_HEAP_SEG (0, 0).addr;
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    void *p;
+
+    if (gsp->addr == want) {
+        return 1;
+        /* NOT REACHED */
+    }
+
+#ifdef MAP_HUGETLB
+    if (great_big_heap_mapped[0] > 0) {
+        flags = heap_map_flags ();
+    }
+#endif /* MAP_HUGETLB */
+#ifdef MAP_FIXED_NOREPLACE
+    flags |= MAP_FIXED_NOREPLACE;
+#endif /* MAP_FIXED_NOREPLACE */
+
+    /* a hint only, so check we got it and didn't clobber anything */
+    p = mmap (want, gsp->size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (p != want) {
+        shmemi_trace (SHMEM_LOG_INIT,
+                      "unable to map symmetric heap at %p (%s)",
+                      want,
+                      (p == MAP_FAILED) ? strerror (errno) : "in use");
+        if (p != MAP_FAILED) {
+            munmap (p, gsp->size);
+        }
+        return 0;
+        /* NOT REACHED */
+    }
+
+    if (great_big_heap_mapped[0] > 0) {
+        munmap (gsp->addr, great_big_heap_mapped[0]);
+    }
+    else {
+        free (gsp->addr);
+        if (heap_hugepages == HUGEPAGES_THP) {
+            (void) hugepage_advise (p, gsp->size);
+        }
+    }
+    gsp->addr = p;
+    great_big_heap_mapped[0] = gsp->size;
+
+    return 1;
 }
 
 #endif /* ! HAVE_MANAGED_SEGMENTS */
@@ -768,13 +1291,19 @@ shmemi_symmetric_memory_init (void)
 {
     const int me = GET_STATE (mype);
     const int npes = GET_STATE (numpes);
+    const size_t heapsize = GET_STATE (heapsize);
+    const int same_wanted =
+        (shmemi_comms_getenv ("SHMEM_SYMMETRIC_HEAP_SAME_ADDRESS") != NULL);
 
     /*
      * calloc zeroes for us
      */
     seginfo_table =
-        (gasnet_seginfo_t *) calloc (npes, sizeof (gasnet_seginfo_t));
-    if (EXPR_UNLIKELY (seginfo_table == (gasnet_seginfo_t *) NULL)) {
+        (gasnet_seginfo_t *) calloc (npes * heap_max_segs (),
+                                     sizeof (gasnet_seginfo_t));
+    heap_seg_order = (int *) calloc (heap_max_segs (), sizeof (int));
+    if (EXPR_UNLIKELY ((seginfo_table == (gasnet_seginfo_t *) NULL) ||
+                       (heap_seg_order == (int *) NULL))) {
         comms_bailout ("could not allocate GASNet segments (%s)",
                        strerror (errno)
                        );
@@ -787,63 +1316,201 @@ shmemi_symmetric_memory_init (void)
      */
 
     {
+        size_t pagesize = GASNET_PAGESIZE;
+
 #ifdef HAVE_MANAGED_SEGMENTS
 
         /* gasnet handles the segment allocation for us */
         GASNET_SAFE (gasnet_getSegmentInfo (seginfo_table, npes));
 
-#else
+        /*
+         * the segment is already mapped, so the most we can do is
+         * ask for transparent huge pages
+         */
+        if (heap_hugepages != HUGEPAGES_NONE) {
+            if (heap_hugepages != HUGEPAGES_THP) {
+                shmemi_trace (SHMEM_LOG_INIT,
+                              "GASNet allocates the segment,"
+                              " using transparent huge pages instead");
+                heap_hugepages = HUGEPAGES_THP;
+            }
+            if (hugepage_advise (seginfo_table[me].addr,
+                                 seginfo_table[me].size)) {
+                pagesize = 0;
+            }
+        }
 
-        const size_t heapsize = GET_STATE (heapsize);
-        int pm_r;
+#else
 
-        /* allocate the heap - has to be pagesize aligned */
-        pm_r = posix_memalign (&great_big_heap, GASNET_PAGESIZE, heapsize);
-        if (EXPR_UNLIKELY (pm_r != 0)) {
-            comms_bailout ("unable to allocate symmetric heap (%s)",
-                           strerror (pm_r)
-                );
+        great_big_heap_mapped =
+            (size_t *) calloc (heap_max_segs (), sizeof (size_t));
+        seg_setup_stage[0] =
+            (gasnet_seginfo_t *) calloc (2 * npes, sizeof (gasnet_seginfo_t));
+        seg_setup_stage[1] = seg_setup_stage[0] + npes;
+        if (EXPR_UNLIKELY ((great_big_heap_mapped == (size_t *) NULL) ||
+                           (seg_setup_stage[0] ==
+                            (gasnet_seginfo_t *) NULL))) {
+            comms_bailout ("could not allocate GASNet segments (%s)",
+                           strerror (errno)
+                           );
             /* NOT REACHED */
         }
 
+        /*
+         * a heap that stays at one address can't grow in new
+         * segments, so reserve all it might need now
+         */
+        pagesize = heap_alloc (0, (same_wanted && (heap_max_size > 0)) ?
+                               heap_max_size : heapsize);
+
         /* everyone has their local info before exchanging messages */
         shmemi_comms_barrier_all ();
 
-        /* store my own heap entry */
-        seginfo_table[me].addr = great_big_heap;
-        seginfo_table[me].size = heapsize;
+        heap_seg_announce (0);
 
-        {
-            gasnet_seginfo_t gs;
-            int pe;
-
-            gs.addr = great_big_heap;
-            gs.size = heapsize;
-
-            for (pe = 0; pe < npes; pe += 1) {
-                /* send to everyone else */
-                if (EXPR_LIKELY (me != pe)) {
-                    gasnet_AMRequestMedium0 (pe, GASNET_HANDLER_setup_out,
-                                             &gs, sizeof (gs)
-                        );
-                }
-            }
-
-            /* now wait on the AM replies (0-based AND don't count myself) */
-            GASNET_BLOCKUNTIL (seg_setup_replies_received == npes - 1);
+        /*
+         * now everyone knows where PE 0's heap is: try to get ours
+         * there too, and tell everyone how that went
+         */
+        if (same_wanted && ! heap_seg_same_address (0)) {
+            (void) heap_move_to_pe0 ();
+            heap_seg_announce (0);
         }
 
 #endif /* HAVE_MANAGED_SEGMENTS */
+
+        /*
+         * everyone has the same table, so everyone makes the same
+         * choice here
+         */
+        heap_same_address = heap_seg_same_address (0);
+        if (heap_same_address) {
+            shmemi_trace (SHMEM_LOG_INIT,
+                          "symmetric heap is at %p on all PEs",
+                          seginfo_table[me].addr);
+        }
+        else if (same_wanted) {
+            shmemi_trace (SHMEM_LOG_INIT,
+                          "symmetric heap can't be at the same address"
+                          " on all PEs, translating addresses");
+        }
+
+        if (pagesize == 0) {
+            shmemi_trace (SHMEM_LOG_INIT,
+                          "symmetric heap of %ld bytes uses"
+                          " transparent huge pages",
+                          heapsize);
+        }
+        else {
+            shmemi_trace (SHMEM_LOG_INIT,
+                          "symmetric heap of %ld bytes uses %ld-byte pages",
+                          heapsize, pagesize);
+        }
+        if (heap_max_size > 0) {
+            shmemi_trace (SHMEM_LOG_INIT,
+                          "symmetric heap can grow to %ld bytes",
+                          heap_max_size);
+        }
     }
 
+    heap_seg_insert (0);
+
+    /* put it on the right NUMA node(s) before the allocator touches it */
+    shmemi_numa_place_heap (seginfo_table[me].addr, seginfo_table[me].size);
+
     /* initialize my heap */
-    shmemi_mem_init (seginfo_table[me].addr, seginfo_table[me].size);
+    shmemi_mem_init (seginfo_table[me].addr, heapsize);
 
     /* and make sure everyone is up-to-speed */
     /* shmemi_comms_barrier_all (); */
 
 }
 
+/**
+ * room for the allocator's own bookkeeping when the heap grows
+ */
+#define HEAP_GROW_SLACK (64 * 1024)
+
+/**
+ * grow the symmetric heap so a request for "need" bytes can be met.
+ * Everyone makes the same allocations, so everyone runs out at the
+ * same point and comes here together.  The heap at least doubles, up
+ * to its maximum size.  Returns non-zero if it grew.
+ */
+static inline int
+shmemi_comms_heap_grow (size_t need)
+{
+    const int me = GET_STATE (mype);
+    const size_t cur = GET_STATE (heapsize);
+    /* heap_alloc may have fallen back, but the sizes weren't */
+    const size_t pagesize = hugepage_size (heap_hugepages_asked);
+    const size_t unit =
+        (pagesize > MEM_SEGMENT_ALIGN) ? pagesize : MEM_SEGMENT_ALIGN;
+    size_t grow;
+    void *base;
+
+    if (cur >= heap_max_size) {
+        return 0;
+        /* NOT REACHED */
+    }
+
+    grow = need + HEAP_GROW_SLACK;
+    if (grow < cur) {
+        grow = cur;
+    }
+    if (grow % unit != 0) {
+        grow += unit - (grow % unit);
+    }
+    if (grow > heap_max_size - cur) {
+        grow = heap_max_size - cur;
+        if (grow < need) {
+            return 0;
+            /* NOT REACHED */
+        }
+    }
+
+#ifdef HAVE_MANAGED_SEGMENTS
+
+    /* the segment was attached at the maximum size: take the next slice */
+    base = (char *) seginfo_table[me].addr + cur;
+
+#else
+
+    if (seginfo_table[me].size >= heap_max_size) {
+        /* reserved at the maximum size: take the next slice */
+        base = (char *) seginfo_table[me].addr + cur;
+    }
+    else if (heap_nsegs == heap_max_segs ()) {
+        return 0;
+        /* NOT REACHED */
+    }
+    else {
+        const int s = heap_nsegs;
+
+        (void) heap_alloc (s, grow);
+        heap_seg_announce (s);
+        heap_seg_insert (s);
+
+        base = SHMEM_SYMMETRIC_HEAP_SEG (s, me).addr;
+        shmemi_numa_place_heap (base, grow);
+    }
+
+#endif /* HAVE_MANAGED_SEGMENTS */
+
+    if (EXPR_UNLIKELY (! shmemi_mem_add (base, grow))) {
+        return 0;
+        /* NOT REACHED */
+    }
+
+    SET_STATE (heapsize, cur + grow);
+
+    shmemi_trace (SHMEM_LOG_MEMORY,
+                  "symmetric heap grew by %ld to %ld bytes",
+                  grow, cur + grow);
+
+    return 1;
+}
+
 /**
  * shut down the memory allocation handler
  */
@@ -852,7 +1519,23 @@ shmemi_symmetric_memory_finalize (void)
 {
     shmemi_mem_finalize ();
 #if ! defined(HAVE_MANAGED_SEGMENTS)
-    free (great_big_heap);
+    {
+        const int me = GET_STATE (mype);
+        int s;
+
+        for (s = 0; s < heap_nsegs; s += 1) {
+            void *addr = SHMEM_SYMMETRIC_HEAP_SEG (s, me).addr;
+
+            if (great_big_heap_mapped[s] > 0) {
+                munmap (addr, great_big_heap_mapped[s]);
+            }
+            else {
+                free (addr);
+            }
+        }
+        free (great_big_heap_mapped);
+        free (seg_setup_stage[0]);
+    }
 #endif /* HAVE_MANAGED_SEGMENTS */
 }
 
@@ -2359,6 +3042,265 @@ shmemi_comms_get_nbi_bulk (void *dst, void *src, size_t len, int pe)
 #endif /* HAVE_MANAGED_SEGMENTS */
 }
 
+/**
+ * ---------------------------------------------------------------------------
+ *
+ * strided put/get: pack the elements locally and ship them in as few
+ * AMs as possible, the other side unpacks.  Chunks are all sent
+ * before we wait for any acks.
+ *
+ */
+
+static gasnet_hsl_t strided_lock = GASNET_HSL_INITIALIZER;
+
+/**
+ * copy nelems elements of size elsize between strided arrays
+ * (strides in elements)
+ */
+static inline void
+strided_copy (void *dst, ptrdiff_t dst_stride,
+              const void *src, ptrdiff_t src_stride,
+              size_t nelems, size_t elsize)
+{
+    size_t i;
+
+#define STRIDED_COPY_TYPE(Type)                                 \
+    {                                                           \
+        Type *d = (Type *) dst;                                 \
+        const Type *s = (const Type *) src;                     \
+        for (i = 0; i < nelems; i += 1) {                       \
+            *d = *s;                                            \
+            d += dst_stride;                                    \
+            s += src_stride;                                    \
+        }                                                       \
+    }
+
+    switch (elsize) {
+    case 1:
+        STRIDED_COPY_TYPE (uint8_t);
+        break;
+    case 2:
+        STRIDED_COPY_TYPE (uint16_t);
+        break;
+    case 4:
+        STRIDED_COPY_TYPE (uint32_t);
+        break;
+    case 8:
+        STRIDED_COPY_TYPE (uint64_t);
+        break;
+    default:
+        {
+            char *d = (char *) dst;
+            const char *s = (const char *) src;
+            const ptrdiff_t dstep = dst_stride * (ptrdiff_t) elsize;
+            const ptrdiff_t sstep = src_stride * (ptrdiff_t) elsize;
+
+            for (i = 0; i < nelems; i += 1) {
+                memcpy (d, s, elsize);
+                d += dstep;
+                s += sstep;
+            }
+        }
+        break;
+    }
+
+#undef STRIDED_COPY_TYPE
+}
+
+/**
+ * count acks on the initiator
+ */
+static inline void
+strided_ack (volatile long *counter)
+{
+    gasnet_hsl_lock (&strided_lock);
+    *counter += 1L;
+    gasnet_hsl_unlock (&strided_lock);
+}
+
+/**
+ * called by remote PE to scatter the packed data into its target
+ */
+static void
+handler_strided_put_out (gasnet_token_t token, void *buf, size_t bufsiz)
+{
+    strided_payload_t *pp = (strided_payload_t *) buf;
+
+    strided_copy (pp->target, pp->tst,
+                  buf + sizeof (*pp), 1, pp->nelems, pp->elsize);
+    LOAD_STORE_FENCE ();
+
+    /* return ack, just need the control structure */
+    gasnet_AMReplyMedium0 (token, GASNET_HANDLER_strided_put_bak,
+                           buf, sizeof (*pp)
+                           );
+}
+
+/**
+ * invoking PE counts the acks
+ */
+static void
+handler_strided_put_bak (gasnet_token_t token, void *buf, size_t bufsiz)
+{
+    strided_payload_t *pp = (strided_payload_t *) buf;
+
+    strided_ack (pp->completed_addr);
+}
+
+/**
+ * called by remote PE to gather its source and send it back packed
+ */
+static void
+handler_strided_get_out (gasnet_token_t token, void *buf, size_t bufsiz)
+{
+    strided_payload_t *pp = (strided_payload_t *) buf;
+    const size_t rsize = sizeof (*pp) + pp->nelems * pp->elsize;
+    void *rbuf = malloc (rsize);
+
+    if (EXPR_UNLIKELY (rbuf == NULL)) {
+        comms_bailout
+            ("internal error: unable to allocate strided get reply buffer");
+        /* NOT REACHED */
+    }
+
+    memcpy (rbuf, pp, sizeof (*pp));
+    strided_copy (rbuf + sizeof (*pp), 1,
+                  pp->source, pp->sst, pp->nelems, pp->elsize);
+    LOAD_STORE_FENCE ();
+
+    gasnet_AMReplyMedium0 (token, GASNET_HANDLER_strided_get_bak,
+                           rbuf, rsize);
+
+    free (rbuf);
+}
+
+/**
+ * called by invoking PE to scatter fetched data into its target
+ */
+static void
+handler_strided_get_bak (gasnet_token_t token, void *buf, size_t bufsiz)
+{
+    strided_payload_t *pp = (strided_payload_t *) buf;
+
+    strided_copy (pp->target, pp->tst,
+                  buf + sizeof (*pp), 1, pp->nelems, pp->elsize);
+    LOAD_STORE_FENCE ();
+
+    strided_ack (pp->completed_addr);
+}
+
+/**
+ * how many elements fit in one AM after the control structure
+ */
+static inline size_t
+strided_chunk_elems (size_t elsize)
+{
+    const size_t max_data =
+        gasnet_AMMaxMedium () - sizeof (strided_payload_t);
+
+    return max_data / elsize;
+}
+
+static inline void
+shmemi_comms_iput (void *target, void *source,
+                   ptrdiff_t tst, ptrdiff_t sst,
+                   size_t nelems, size_t elsize, int pe)
+{
+    const size_t per_chunk = strided_chunk_elems (elsize);
+    strided_payload_t *p;
+    void *their_target;
+    volatile long acked = 0L;
+    long sent = 0L;
+    size_t done;
+    size_t n;
+
+    /* contiguous is just a plain put */
+    if ( (tst == 1) && (sst == 1) ) {
+        shmemi_comms_put_bulk (target, source, nelems * elsize, pe);
+        return;
+    }
+
+    if (EXPR_UNLIKELY (nelems == 0)) {
+        return;
+    }
+
+    their_target = shmemi_symmetric_addr_lookup (target, pe);
+
+    allocate_buffer_and_check ((void **) &p, gasnet_AMMaxMedium ());
+
+    for (done = 0; done < nelems; done += n) {
+        n = nelems - done;
+        if (n > per_chunk) {
+            n = per_chunk;
+        }
+
+        p->target = their_target + (ptrdiff_t) done * tst * elsize;
+        p->source = NULL;        /* not used in put */
+        p->tst = tst;
+        p->sst = 1;
+        p->nelems = n;
+        p->elsize = elsize;
+        p->completed_addr = &acked;
+
+        strided_copy ((void *) p + sizeof (*p), 1,
+                      source + (ptrdiff_t) done * sst * elsize, sst,
+                      n, elsize);
+        LOAD_STORE_FENCE ();
+
+        /* payload is copied out by GASNet, so buffer can be reused */
+        gasnet_AMRequestMedium0 (pe, GASNET_HANDLER_strided_put_out,
+                                 p, sizeof (*p) + n * elsize);
+        sent += 1L;
+    }
+
+    WAIT_ON_COMPLETION (acked == sent);
+
+    free (p);
+}
+
+static inline void
+shmemi_comms_iget (void *target, void *source,
+                   ptrdiff_t tst, ptrdiff_t sst,
+                   size_t nelems, size_t elsize, int pe)
+{
+    const size_t per_chunk = strided_chunk_elems (elsize);
+    strided_payload_t req;
+    void *their_source;
+    volatile long acked = 0L;
+    long sent = 0L;
+    size_t done;
+    size_t n;
+
+    /* contiguous is just a plain get */
+    if ( (tst == 1) && (sst == 1) ) {
+        shmemi_comms_get_bulk (target, source, nelems * elsize, pe);
+        return;
+    }
+
+    their_source = shmemi_symmetric_addr_lookup (source, pe);
+
+    for (done = 0; done < nelems; done += n) {
+        n = nelems - done;
+        if (n > per_chunk) {
+            n = per_chunk;
+        }
+
+        req.target = target + (ptrdiff_t) done * tst * elsize;
+        req.source = their_source + (ptrdiff_t) done * sst * elsize;
+        req.tst = tst;
+        req.sst = sst;
+        req.nelems = n;
+        req.elsize = elsize;
+        req.completed_addr = &acked;
+
+        gasnet_AMRequestMedium0 (pe, GASNET_HANDLER_strided_get_out,
+                                 &req, sizeof (req));
+        sent += 1L;
+    }
+
+    WAIT_ON_COMPLETION (acked == sent);
+}
+
 /**
  * ---------------------------------------------------------------------------
  *
@@ -2655,7 +3597,6 @@ shmemi_comms_globalexit_request (int status)
 static gasnet_handlerentry_t handlers[] = {
 #if ! defined(HAVE_MANAGED_SEGMENTS)
     {GASNET_HANDLER_setup_out, handler_segsetup_out},
-    {GASNET_HANDLER_setup_bak, handler_segsetup_bak},
 #endif /* ! HAVE_MANAGED_SEGMENTS */
 
     AMO_HANDLER_LOOKUP (swap, int),
@@ -2709,6 +3650,10 @@ static gasnet_handlerentry_t handlers[] = {
     {GASNET_HANDLER_globalvar_get_out, handler_globalvar_get_out},
     {GASNET_HANDLER_globalvar_get_bak, handler_globalvar_get_bak},
 #endif /* HAVE_MANAGED_SEGMENTS */
+    {GASNET_HANDLER_strided_put_out, handler_strided_put_out},
+    {GASNET_HANDLER_strided_put_bak, handler_strided_put_bak},
+    {GASNET_HANDLER_strided_get_out, handler_strided_get_out},
+    {GASNET_HANDLER_strided_get_bak, handler_strided_get_bak},
     {GASNET_HANDLER_globalexit_out, handler_globalexit_out}
     /* no reply partner for global_exit */
 };
@@ -2843,6 +3788,9 @@ shmemi_comms_exit (int status)
 
     shmemi_service_finalize ();
 
+    /* forget collective schedules */
+    shmemi_schedule_finalize ();
+
     /* clean up atomics and memory */
     shmemi_atomic_finalize ();
     shmemi_symmetric_memory_finalize ();
@@ -2886,51 +3834,128 @@ shmemi_comms_finalize (void)
     shmemi_comms_exit (EXIT_SUCCESS);
 }
 
+/**
+ * how long each phase of start-up took, reported with SHMEM_LOG_INIT
+ * once tracing is up
+ */
+#define INIT_MAX_PHASES 32
+
+typedef struct
+{
+    const char *name[INIT_MAX_PHASES];
+    double secs[INIT_MAX_PHASES];
+    int nphases;
+    double started;
+    double last;
+} init_timing_t;
+
+static inline void
+init_timing_start (init_timing_t *itp)
+{
+    itp->nphases = 0;
+    itp->started = itp->last = shmemi_elapsed_clock_get ();
+}
+
+/**
+ * the phase called "name" ends now
+ */
+static inline void
+init_timing_mark (init_timing_t *itp, const char *name)
+{
+    const double now = shmemi_elapsed_clock_get ();
+
+    if (itp->nphases < INIT_MAX_PHASES) {
+        itp->name[itp->nphases] = name;
+        itp->secs[itp->nphases] = now - itp->last;
+        itp->nphases += 1;
+    }
+    itp->last = now;
+}
+
+static inline void
+init_timing_show (init_timing_t *itp)
+{
+    int i;
+
+    if (! shmemi_trace_is_enabled (SHMEM_LOG_INIT)) {
+        return;
+        /* NOT REACHED */
+    }
+
+    for (i = 0; i < itp->nphases; i += 1) {
+        shmemi_trace (SHMEM_LOG_INIT,
+                      "start-up phase \"%s\" took %.6f s",
+                      itp->name[i], itp->secs[i]);
+    }
+    shmemi_trace (SHMEM_LOG_INIT,
+                  "start-up took %.6f s",
+                  itp->last - itp->started);
+}
+
 /**
  * This is where the communications layer gets set up and torn down
  */
 static inline void
 shmemi_comms_init (void)
 {
+    init_timing_t it;
+
+    /* start the clock first, so start-up itself can be timed */
+    shmemi_elapsed_clock_init ();
+    init_timing_start (&it);
+
     /*
      * prepare environment for GASNet
      */
     parse_cmdline ();
     maximize_gasnet_timeout ();
+    init_timing_mark (&it, "command line");
 
     GASNET_SAFE (gasnet_init (&argc, &argv));
+    init_timing_mark (&it, "gasnet_init");
 
     /* now we can ask about the node count & heap */
     SET_STATE (mype, shmemi_comms_mynode ());
     SET_STATE (numpes, shmemi_comms_nodes ());
     SET_STATE (heapsize, shmemi_comms_get_segment_size ());
+    heap_max_size = shmemi_comms_get_segment_max_size ();
 
     /*
      * not guarding the attach for different gasnet models,
-     * since last 2 params are ignored if not needed
+     * since last 2 params are ignored if not needed.  A heap that
+     * can grow reserves its maximum size up front.
      */
     GASNET_SAFE (gasnet_attach (handlers, nhandlers,
-                                GET_STATE (heapsize), 0)
+                                (heap_max_size > 0) ?
+                                heap_max_size : GET_STATE (heapsize), 0)
                  );
+    init_timing_mark (&it, "gasnet_attach");
 
     /* set up any locality information */
     place_init ();
+    init_timing_mark (&it, "locality");
 
     /* fire up any needed progress management */
     shmemi_service_init ();
 
     /* enable messages */
-    shmemi_elapsed_clock_init ();
     shmemi_tracers_init ();
 
+    /* where memory and the progress thread should live */
+    shmemi_numa_init ();
+    shmemi_service_place ();
+    init_timing_mark (&it, "service and placement");
+
     /* who am I? */
     shmemi_executable_init ();
 
     /* find global symbols */
     shmemi_symmetric_globalvar_table_init ();
+    init_timing_mark (&it, "global variables");
 
     /* handle the heap */
     shmemi_symmetric_memory_init ();
+    init_timing_mark (&it, "symmetric heap");
 
     /* which message/trace levels are active */
     shmemi_maybe_tracers_show_info ();
@@ -2939,12 +3964,25 @@ shmemi_comms_init (void)
     /* set up the atomic ops handling */
     shmemi_atomic_init ();
 
+    /* see which PEs share a host */
+    shmemi_locality_init ();
+    init_timing_mark (&it, "atomics and host locality");
+
+    /* remember collective trees etc. between calls */
+    shmemi_schedule_init ();
+
     /* initialize collective algs */
     shmemi_barrier_dispatch_init ();
     shmemi_barrier_all_dispatch_init ();
     shmemi_broadcast_dispatch_init ();
     shmemi_collect_dispatch_init ();
     shmemi_fcollect_dispatch_init ();
+    shmemi_alltoall_dispatch_init ();
+    shmemi_reduce_dispatch_init ();
+    init_timing_mark (&it, "collectives");
+
+    /* which shared objects' globals are symmetric */
+    shmemi_symmetric_globalvar_dso_init ();
 
     /* register shutdown handler */
     if (EXPR_UNLIKELY (atexit (shmemi_comms_finalize) != 0)) {
@@ -2954,6 +3992,8 @@ shmemi_comms_init (void)
         /* NOT REACHED */
     }
 
+    init_timing_show (&it);
+
     SET_STATE (pe_status, PE_RUNNING);
 
     /* Up and running! */
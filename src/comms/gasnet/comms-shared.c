@@ -69,22 +69,37 @@
 
 gasnet_seginfo_t *seginfo_table;
 
+gasnet_nodeinfo_t *nodeinfo_table;
+
+heap_hugepages_t heap_hugepages = HUGEPAGES_NONE;
+
+heap_hugepages_t heap_hugepages_asked = HUGEPAGES_NONE;
+
+size_t heap_max_size = 0;
+
+int heap_nsegs = 0;
+
+int *heap_seg_order;
+
+int heap_same_address = 0;
+
 #if ! defined(HAVE_MANAGED_SEGMENTS)
 
 /**
- * this will be malloc'ed so we can respect setting from environment
- * variable
+ * the segments will be malloc'ed (or mmap'ed) so we can respect
+ * settings from environment variables
  */
 
-void *great_big_heap;
+size_t *great_big_heap_mapped;
 
 /**
- * remotely modified, stop it being put in a register
+ * staging for the segment exchange, remotely modified
  */
-volatile int seg_setup_replies_received = 0;
+gasnet_seginfo_t *seg_setup_stage[2];
+volatile int seg_setup_received[2][SEG_SETUP_MAX_ROUNDS];
+int seg_setup_calls = 0;
 
 gasnet_hsl_t setup_out_lock = GASNET_HSL_INITIALIZER;
-gasnet_hsl_t setup_bak_lock = GASNET_HSL_INITIALIZER;
 
 #endif /* ! HAVE_MANAGED_SEGMENTS */
 
@@ -51,6 +51,8 @@
 #ifndef _SHMEM_COMMS_H
 #define _SHMEM_COMMS_H 1
 
+#include <stddef.h>
+
 #include <gasnet.h>
 
 #if defined(GASNET_SEGMENT_FAST)
@@ -72,6 +74,47 @@
 
 extern gasnet_seginfo_t *seginfo_table;
 
+/**
+ * host, supernode and PSHM offset of every PE
+ */
+extern gasnet_nodeinfo_t *nodeinfo_table;
+
+/**
+ * what SHMEM_SYMMETRIC_HEAP_HUGEPAGES asked the heap to be backed by
+ */
+typedef enum
+{
+    HUGEPAGES_NONE = 0,
+    HUGEPAGES_2M,
+    HUGEPAGES_1G,
+    HUGEPAGES_THP
+} heap_hugepages_t;
+
+extern heap_hugepages_t heap_hugepages;
+
+/*
+ * what was asked for, before any fallback: sizes are rounded to this
+ * so they come out the same whatever the segments ended up with
+ */
+extern heap_hugepages_t heap_hugepages_asked;
+
+/**
+ * how far the heap may grow (0 if it can't), and its segments.
+ * Segment S of PE P is seginfo_table[S * npes + P].  heap_seg_order
+ * lists my segments in address order.
+ */
+extern size_t heap_max_size;
+
+extern int heap_nsegs;
+
+extern int *heap_seg_order;
+
+/**
+ * non-zero if the heap is at the same address on all PEs, so
+ * symmetric addresses need no translation
+ */
+extern int heap_same_address;
+
 #if ! defined(HAVE_MANAGED_SEGMENTS)
 
 /**
@@ -81,7 +124,29 @@ extern gasnet_seginfo_t *seginfo_table;
 
 #define DEFAULT_HEAP_SIZE 33554432L /* 32M */
 
-extern void *great_big_heap;
+/**
+ * per segment, non-zero if it was mmap'ed from huge pages rather
+ * than malloc'ed
+ */
+extern size_t *great_big_heap_mapped;
+
+/**
+ * a run of segment table entries passed on in the segment exchange.
+ * The entries follow the header in the AM payload.
+ */
+typedef struct
+{
+    int seg;                    /* which segment */
+    int call;                   /* which exchange */
+    int round;                  /* dissemination round */
+    int first;                  /* PE of first entry */
+    int count;                  /* # entries */
+} seg_announce_t;
+
+/**
+ * a dissemination round for each bit of a PE number
+ */
+#define SEG_SETUP_MAX_ROUNDS 32
 
 #else
 
@@ -97,12 +162,34 @@ typedef struct
 #endif /* ! HAVE_MANAGED_SEGMENTS */
 
 /**
- * remotely modified, stop it being put in a register
+ * control structure for strided put/get, packed elements follow it
+ * in the AM payload.  Strides are in elements.
+ */
+typedef struct
+{
+    void *target;               /* where to scatter */
+    void *source;               /* where to gather from */
+    ptrdiff_t tst;              /* target stride */
+    ptrdiff_t sst;              /* source stride */
+    size_t nelems;              /* # elements in this chunk */
+    size_t elsize;              /* size of 1 element */
+    volatile long *completed_addr;  /* chunk counter on initiator */
+} strided_payload_t;
+
+#if ! defined(HAVE_MANAGED_SEGMENTS)
+
+/**
+ * entries arrive in a staging table, and are counted per round.  Odd
+ * and even exchanges use their own, since a quick PE may already be
+ * into the next one.
  */
-extern volatile int seg_setup_replies_received;
+extern gasnet_seginfo_t *seg_setup_stage[2];
+extern volatile int seg_setup_received[2][SEG_SETUP_MAX_ROUNDS];
+extern int seg_setup_calls;
 
 extern gasnet_hsl_t setup_out_lock;
-extern gasnet_hsl_t setup_bak_lock;
+
+#endif /* ! HAVE_MANAGED_SEGMENTS */
 
 /**
  * remotely modified, stop it being put in a register
@@ -5389,6 +5389,43 @@ struct mallinfo mspace_mallinfo(mspace msp) {
   }
   return internal_mallinfo(ms);
 }
+
+/*
+  mspace_free_stats reports the total free space in the mspace and
+  the largest single free chunk, to show how fragmented it is.
+  (Added for OpenSHMEM heap statistics.)
+*/
+void mspace_free_stats(mspace msp, size_t* total, size_t* largest) {
+  mstate m = (mstate)msp;
+  *total = *largest = 0;
+  if (!ok_magic(m)) {
+    USAGE_ERROR_ACTION(m,m);
+    return;
+  }
+  ensure_initialization();
+  if (!PREACTION(m)) {
+    check_malloc_state(m);
+    if (is_initialized(m)) {
+      msegmentptr s = &m->seg;
+      *total = *largest = m->topsize;
+      while (s != 0) {
+        mchunkptr q = align_as_chunk(s->base);
+        while (segment_holds(s, q) &&
+               q != m->top && q->head != FENCEPOST_HEAD) {
+          if (!is_inuse(q)) {
+            size_t sz = chunksize(q);
+            *total += sz;
+            if (sz > *largest)
+              *largest = sz;
+          }
+          q = next_chunk(q);
+        }
+        s = s->next;
+      }
+    }
+    POSTACTION(m);
+  }
+}
 #endif /* NO_MALLINFO */
 
 size_t mspace_usable_size(void* mem) {
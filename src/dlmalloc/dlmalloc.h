@@ -31,4 +31,8 @@ extern void mspace_free(mspace msp, void *mem);
 
 extern size_t mspace_footprint(mspace msp);
 
+extern size_t mspace_usable_size(void *mem);
+
+extern void mspace_free_stats(mspace msp, size_t *total, size_t *largest);
+
 #endif /* _DLMALLOC_H */
@@ -0,0 +1,164 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include <sys/types.h>
+#include <string.h>
+
+#include "state.h"
+#include "trace.h"
+#include "locality.h"
+
+#include "shmem.h"
+
+#include "fcollect-impl.h"
+
+/*
+ * Two-level fcollect: each leader copies its host's blocks into its
+ * own target through shared memory, sends them on to the other leaders
+ * (one put per run of adjacent blocks), and once the leaders have all
+ * synchronized, its host copies the whole target back out.
+ *
+ * Returns 0 if the set isn't worth (or able) doing this way.
+ *
+ */
+
+static int
+fcollect_hierarchical (void *target, const void *source, size_t nbytes,
+                       int PE_start, int logPE_stride, int PE_size,
+                       long *pSync)
+{
+    const int step = 1 << logPE_stride;
+    char *tp = (char *) target;
+    shmemi_locality_t *lp;
+
+    lp = shmemi_locality_lookup (PE_start, logPE_stride, PE_size,
+                                 0, pSync);
+    if (lp == NULL) {
+        return 0;
+    }
+    /* symmetric, so all PEs agree on this */
+    if (shmemi_locality_ptr (lp, target, lp->lrank) == NULL ||
+        shmemi_locality_ptr (lp, source, lp->lrank) == NULL) {
+        return 0;
+    }
+
+    /* wait for the sources on my host */
+    shmemi_locality_gather (lp, pSync);
+
+    if (lp->lrank == 0) {
+        int i, n, run;
+
+        for (i = 0; i < lp->nlocal; i += 1) {
+            const int vpe = (lp->locals[i] - PE_start) >> logPE_stride;
+
+            memcpy (tp + vpe * nbytes,
+                    (i == 0) ? source :
+                    shmemi_locality_ptr (lp, source, i), nbytes);
+        }
+
+        for (n = 1; n < lp->nnodes; n += 1) {
+            const int pe = lp->leaders[(lp->node + n) % lp->nnodes];
+
+            for (i = 0; i < lp->nlocal; i = run) {
+                const int vpe = (lp->locals[i] - PE_start) >> logPE_stride;
+
+                for (run = i + 1;
+                     run < lp->nlocal &&
+                         lp->locals[run] == lp->locals[run - 1] + step;
+                     run += 1) {
+                    ;
+                }
+                shmem_putmem (tp + vpe * nbytes, tp + vpe * nbytes,
+                              (run - i) * nbytes, pe);
+            }
+        }
+
+        shmem_quiet ();
+        shmemi_locality_leader_barrier (lp, pSync);
+
+        shmemi_trace (SHMEM_LOG_COLLECT,
+                      "leader has all %d blocks", PE_size);
+    }
+
+    /* copy out the full target, leader keeps it until we're done */
+    shmemi_locality_release (lp, pSync);
+    if (lp->lrank != 0) {
+        memcpy (target, shmemi_locality_ptr (lp, target, 0),
+                PE_size * nbytes);
+    }
+    shmemi_locality_gather (lp, pSync);
+    shmemi_locality_release (lp, pSync);
+
+    return 1;
+}
+
+#define SHMEM_FCOLLECT_HIERARCHICAL(Bits, Bytes)                        \
+    void                                                                \
+    shmemi_fcollect##Bits##_hierarchical (void *target,                 \
+                                          const void *source,           \
+                                          size_t nelems,                \
+                                          int PE_start, int logPE_stride, \
+                                          int PE_size,                  \
+                                          long *pSync)                  \
+    {                                                                   \
+        if (! fcollect_hierarchical (target, source, nelems * Bytes,    \
+                                     PE_start, logPE_stride, PE_size,   \
+                                     pSync)) {                          \
+            shmemi_fcollect##Bits##_linear (target, source, nelems,     \
+                                            PE_start, logPE_stride,     \
+                                            PE_size, pSync);            \
+        }                                                               \
+    }
+
+SHMEM_FCOLLECT_HIERARCHICAL (32, 4);
+SHMEM_FCOLLECT_HIERARCHICAL (64, 8);
+SHMEM_FCOLLECT_HIERARCHICAL (mem, 1);
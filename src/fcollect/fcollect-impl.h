@@ -53,5 +53,10 @@
 
 extern void shmemi_fcollect32_linear ();
 extern void shmemi_fcollect64_linear ();
+extern void shmemi_fcollectmem_linear ();
+
+extern void shmemi_fcollect32_hierarchical ();
+extern void shmemi_fcollect64_hierarchical ();
+extern void shmemi_fcollectmem_hierarchical ();
 
 #endif
@@ -91,3 +91,4 @@
 
 SHMEM_FCOLLECT (32, 4);
 SHMEM_FCOLLECT (64, 8);
+SHMEM_FCOLLECT (mem, 1);
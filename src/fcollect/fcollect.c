@@ -56,6 +56,8 @@
 #include "comms.h"
 #include "trace.h"
 #include "utils.h"
+#include "locality.h"
+#include "tune.h"
 
 #include "shmem.h"
 
@@ -65,10 +67,31 @@
 #include "pshmem.h"
 #endif /* HAVE_FEATURE_PSHMEM */
 
+#ifdef HAVE_FEATURE_EXPERIMENTAL
+#include "shmemx.h"
+#ifdef HAVE_FEATURE_PSHMEM
+#include "pshmemx.h"
+#endif /* HAVE_FEATURE_PSHMEM */
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
+
 static char *default_implementation = "linear";
 
-static void (*func32) ();
-static void (*func64) ();
+static const shmemi_tune_algorithm_t algorithms[] = {
+    { "linear",
+      shmemi_fcollect32_linear, shmemi_fcollect64_linear,
+      shmemi_fcollectmem_linear },
+    { "hierarchical",
+      shmemi_fcollect32_hierarchical, shmemi_fcollect64_hierarchical,
+      shmemi_fcollectmem_hierarchical },
+};
+
+static int chosen;
+static int use_table = 1;
+
+/*
+ * called during initialization of shmem
+ *
+ */
 
 void
 shmemi_fcollect_dispatch_init (void)
@@ -76,21 +99,45 @@ shmemi_fcollect_dispatch_init (void)
     char *name = shmemi_comms_getenv ("SHMEM_FCOLLECT_ALGORITHM");
 
     if (EXPR_LIKELY (name == (char *) NULL)) {
-        name = default_implementation;
-    }
-
-    if (strcmp (name, "linear") == 0) {
-        func32 = shmemi_fcollect32_linear;
-        func64 = shmemi_fcollect64_linear;
+        name = shmemi_locality_available () ?
+            "hierarchical" : default_implementation;
     }
     else {
-        ;                       /* error */
+        use_table = 0;          /* user asked for this one */
     }
 
+    chosen = shmemi_tune_find (algorithms, TUNE_COUNT (algorithms), name);
+    if (EXPR_UNLIKELY (chosen < 0)) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "unsupported fcollect \"%s\"",
+                      name);
+        return;
+        /* NOT REACHED */
+    }
+
+    shmemi_tune_register (TUNE_FCOLLECT, algorithms, TUNE_COUNT (algorithms));
+
     /*
-     * report which implementation we set up
+     * report which fcollect implementation we set up
      */
-    shmemi_trace (SHMEM_LOG_BROADCAST, "using collect \"%s\"", name);
+    shmemi_trace (SHMEM_LOG_COLLECT, "using fcollect \"%s\"", name);
+}
+
+/**
+ * the tuning table, if any, can pick a better algorithm for this
+ * call's shape
+ */
+static inline const shmemi_tune_algorithm_t *
+pick (int PE_size, size_t nbytes)
+{
+    if (use_table) {
+        const int i = shmemi_tune_lookup (TUNE_FCOLLECT, PE_size, nbytes);
+
+        if (i >= 0) {
+            return &algorithms[i];
+        }
+    }
+    return &algorithms[chosen];
 }
 
 /*
@@ -120,7 +167,9 @@ shmem_fcollect32 (void *target, const void *source, size_t nelems,
     PE_RANGE_CHECK (PE_start, 4, debug_name);
     /* PE_RANGE_CHECK (PE_size, 6, debug_name); */
 
-    func32 (target, source, nelems, PE_start, logPE_stride, PE_size, pSync);
+    pick (PE_size, nelems * 4)->func32 (target, source, nelems,
+                                        PE_start, logPE_stride, PE_size,
+                                        pSync);
 }
 
 
@@ -146,5 +195,37 @@ shmem_fcollect64 (void *target, const void *source, size_t nelems,
     PE_RANGE_CHECK (PE_start, 4, debug_name);
     /* PE_RANGE_CHECK (PE_size, 6, debug_name); */
 
-    func64 (target, source, nelems, PE_start, logPE_stride, PE_size, pSync);
+    pick (PE_size, nelems * 8)->func64 (target, source, nelems,
+                                        PE_start, logPE_stride, PE_size,
+                                        pSync);
 }
+
+#ifdef HAVE_FEATURE_EXPERIMENTAL
+
+#ifdef HAVE_FEATURE_PSHMEM
+#pragma weak shmemx_fcollectmem = pshmemx_fcollectmem
+#define shmemx_fcollectmem pshmemx_fcollectmem
+#endif /* HAVE_FEATURE_PSHMEM */
+
+/**
+ * Collective concatenation of nbytes of untyped data from
+ * participating PEs into a target array on all those PEs
+ */
+
+void
+shmemx_fcollectmem (void *target, const void *source, size_t nbytes,
+                    int PE_start, int logPE_stride, int PE_size, long *pSync)
+{
+    DEBUG_NAME ("shmemx_fcollectmem");
+    INIT_CHECK (debug_name);
+    SYMMETRY_CHECK (target, 1, debug_name);
+    SYMMETRY_CHECK (source, 2, debug_name);
+    SYMMETRY_CHECK (pSync, 7, debug_name);
+    PE_RANGE_CHECK (PE_start, 4, debug_name);
+
+    pick (PE_size, nbytes)->funcmem (target, source, nbytes,
+                                     PE_start, logPE_stride, PE_size,
+                                     pSync);
+}
+
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
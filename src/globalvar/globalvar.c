@@ -49,7 +49,10 @@
  *
  */
 
+#define _GNU_SOURCE 1
+
 #include <gelf.h>
+#include <link.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -59,9 +62,13 @@
 #include "state.h"
 #include "trace.h"
 #include "exe.h"
+#include "comms.h"
+#include "memalloc.h"
 
 #include "utils.h"
 
+#include "shmem.h"
+
 /*
  * ---------------------------------------------------------------------------
  *
@@ -98,53 +105,95 @@ static global_area_t elfbss;    /* uninitialized */
 static global_area_t elfdata;   /* initialized */
 static global_area_t elfro;     /* read-only */
 
+/*
+ * areas of loaded shared objects that can hold global variables,
+ * sorted by address.  Only those at the same address on all PEs are
+ * kept.
+ */
+
+static global_area_t *dso_areas = NULL;
+static int dso_nareas = 0;
+static int dso_maxareas = 0;
+
 
 /*
- * scan the ELF image to build table of global symbold and the image
- * regions where they can be found (BSS and DATA)
+ * libelf can map the file rather than read it all in, so only the
+ * parts we look at are touched
  */
-static inline int
-table_init_helper (void)
+#ifdef ELF_C_READ_MMAP
+#define GLOBALVAR_ELF_CMD ELF_C_READ_MMAP
+#else
+#define GLOBALVAR_ELF_CMD ELF_C_READ
+#endif /* ELF_C_READ_MMAP */
+
+/*
+ * get the ELF object from already opened state, and do some sanity
+ * checks.  NULL if it's not usable.
+ */
+static Elf *
+elf_open (void)
 {
-    Elf *e = NULL;
+    Elf *e;
     GElf_Ehdr ehdr;
-    char *shstr_name = NULL;
-    size_t shstrndx;
-    Elf_Scn *scn = NULL;
-    GElf_Shdr shdr;
-    int ret = -1;
-#if 0
-    int (*getsi) ();            /* look up name of elf_get... routine */
-#endif
 
     /* unrecognized format */
     if (elf_version (EV_CURRENT) == EV_NONE) {
-        goto bail;
+        return NULL;
+        /* NOT REACHED */
     }
 
-    /* get the ELF object from already opened state */
-    e = elf_begin (GET_STATE (exe_fd), ELF_C_READ, NULL);
+    e = elf_begin (GET_STATE (exe_fd), GLOBALVAR_ELF_CMD, NULL);
     if (e == NULL) {
-        goto bail;
+        return NULL;
+        /* NOT REACHED */
     }
 
-    /* do some sanity checks */
-    if (elf_kind (e) != ELF_K_ELF) {
-        goto bail;
-    }
-    if (gelf_getehdr (e, &ehdr) == NULL) {
-        goto bail;
-    }
-    if (gelf_getclass (e) == ELFCLASSNONE) {
-        goto bail;
+    if ((elf_kind (e) != ELF_K_ELF) ||
+        (gelf_getehdr (e, &ehdr) == NULL) ||
+        (gelf_getclass (e) == ELFCLASSNONE)) {
+        (void) elf_end (e);
+        return NULL;
+        /* NOT REACHED */
     }
 
-    /*
-     * There are various elf_get* routines with different return values
-     * in differnt libraries/versions - name of routine does not tell us
-     * all we ned to know.  So let it go here, and we'll mop up any
-     * problems later on.
-     */
+    return e;
+}
+
+/*
+ * record section "name" as global area "ga" if it's one we want
+ */
+static inline void
+note_area (global_area_t * ga, const char *name, const GElf_Shdr * shp)
+{
+    ga->start = shp->sh_addr;
+    ga->end = ga->start + shp->sh_size;
+
+    shmemi_trace (SHMEM_LOG_SYMBOLS,
+                  "ELF section %s for"
+                  " global variables = 0x%lX -> 0x%lX",
+                  name, ga->start, ga->end);
+}
+
+/*
+ * scan the ELF section headers for the image regions where global
+ * variables can be found (RO, BSS and DATA).  Only the headers are
+ * read, however big the symbol table is.
+ */
+static inline int
+table_init_helper (void)
+{
+    Elf *e;
+    char *shstr_name = NULL;
+    size_t shstrndx;
+    Elf_Scn *scn = NULL;
+    GElf_Shdr shdr;
+    int ret = 0;
+
+    e = elf_open ();
+    if (e == NULL) {
+        return -1;
+        /* NOT REACHED */
+    }
 
     /*
      * This routine is either "elf_getshdrstrndx" in newer ELF
@@ -156,125 +205,130 @@ table_init_helper (void)
      */
     (void) elf_getshstrndx (e, &shstrndx);
 
-    /* walk sections, look for RO/BSS/DATA and symbol table */
-    scn = NULL;
-
+    /* walk sections, look for RO/BSS/DATA */
     while ((scn = elf_nextscn (e, scn)) != NULL) {
 
         if (gelf_getshdr (scn, &shdr) != &shdr) {
-            goto bail;
+            ret = -1;
+            break;
         }
         shstr_name = elf_strptr (e, shstrndx, shdr.sh_name);
         if (shstr_name == NULL) {
-            goto bail;
+            ret = -1;
+            break;
         }
 
-        /* found the read-only data */
         if ((shdr.sh_type == SHT_PROGBITS) &&
             (strcmp (shstr_name, ".rodata") == 0)) {
-
-            elfro.start = shdr.sh_addr;
-            elfro.end = elfro.start + shdr.sh_size;
-
-            shmemi_trace (SHMEM_LOG_SYMBOLS,
-                          "ELF section .rodata for"
-                          " global variables = 0x%lX -> 0x%lX",
-                          elfro.start, elfro.end);
-            continue;           /* move to next scan */
+            note_area (&elfro, shstr_name, &shdr);
+        }
+        else if ((shdr.sh_type == SHT_NOBITS) &&
+                 (strcmp (shstr_name, ".bss") == 0)) {
+            note_area (&elfbss, shstr_name, &shdr);
         }
+        else if ((shdr.sh_type == SHT_PROGBITS) &&
+                 (strcmp (shstr_name, ".data") == 0)) {
+            note_area (&elfdata, shstr_name, &shdr);
+        }
+    }
 
-        /* found the uninitialized globals */
-        if (shdr.sh_type == SHT_NOBITS && strcmp (shstr_name, ".bss") == 0) {
+    if (elf_end (e) != 0) {
+        ret = -1;
+    }
 
-            elfbss.start = shdr.sh_addr;
-            elfbss.end = elfbss.start + shdr.sh_size;
+    return ret;
+}
 
-            shmemi_trace (SHMEM_LOG_SYMBOLS,
-                          "ELF section .bss for"
-                          " global variables = 0x%lX -> 0x%lX",
-                          elfbss.start, elfbss.end);
-            continue;           /* move to next scan */
-        }
+/*
+ * walk the ELF symbol table to build the table of global symbols.
+ * This can be big, so it is only done on demand.
+ */
+static int
+symbols_init_helper (void)
+{
+    Elf *e;
+    Elf_Scn *scn = NULL;
+    GElf_Shdr shdr;
+    int ret = -1;
 
-        /* found the initialized globals */
-        if ((shdr.sh_type == SHT_PROGBITS) &&
-            (strcmp (shstr_name, ".data") == 0)) {
+    e = elf_open ();
+    if (e == NULL) {
+        return -1;
+        /* NOT REACHED */
+    }
 
-            elfdata.start = shdr.sh_addr;
-            elfdata.end = elfdata.start + shdr.sh_size;
+    /* keep looking until we find the symbol table */
+    while ((scn = elf_nextscn (e, scn)) != NULL) {
+        Elf_Data *data = NULL;
 
-            shmemi_trace (SHMEM_LOG_SYMBOLS,
-                          "ELF section .data for"
-                          " global variables = 0x%lX -> 0x%lX",
-                          elfdata.start, elfdata.end);
-            continue;           /* move to next scan */
+        if (gelf_getshdr (scn, &shdr) != &shdr) {
+            goto bail;
+        }
+        if (shdr.sh_type != SHT_SYMTAB) {
+            continue;
         }
 
-        /* keep looking until we find the symbol table */
-        if (shdr.sh_type == SHT_SYMTAB) {
-            Elf_Data *data = NULL;
-            while ((data = elf_getdata (scn, data)) != NULL) {
-                GElf_Sym *es;
-                GElf_Sym *last_es;
+        while ((data = elf_getdata (scn, data)) != NULL) {
+            GElf_Sym *es;
+            GElf_Sym *last_es;
 
-                es = (GElf_Sym *) data->d_buf;
-                if (es == NULL) {
-                    continue;
-                }
+            es = (GElf_Sym *) data->d_buf;
+            if (es == NULL) {
+                continue;
+            }
 
-                /* find out how many entries to look for */
-                last_es = (GElf_Sym *) ((char *) data->d_buf + data->d_size);
+            /* find out how many entries to look for */
+            last_es = (GElf_Sym *) ((char *) data->d_buf + data->d_size);
 
-                for (; es < last_es; es += 1) {
-                    char *name;
+            for (; es < last_es; es += 1) {
+                char *name;
 
-                    /*
-                     * need visible global or local (Fortran save) object with
-                     * some kind of content
-                     */
-                    if (es->st_value == 0 || es->st_size == 0) {
-                        continue;
-                    }
-                    /*
-                     * this macro handles a symbol that is present
-                     * in one libelf implementation but isn't in another
-                     * (elfutils vs. libelf)
-                     */
+                /*
+                 * need visible global or local (Fortran save) object with
+                 * some kind of content
+                 */
+                if (es->st_value == 0 || es->st_size == 0) {
+                    continue;
+                }
+                /*
+                 * this macro handles a symbol that is present
+                 * in one libelf implementation but isn't in another
+                 * (elfutils vs. libelf)
+                 */
 #ifndef GELF_ST_VISIBILITY
 #define GELF_ST_VISIBILITY(o) ELF64_ST_VISIBILITY(o)
 #endif
-                    if (GELF_ST_TYPE (es->st_info) != STT_OBJECT &&
-                        GELF_ST_VISIBILITY (es->st_info) != STV_DEFAULT) {
-                        continue;
-                    }
-                    name = elf_strptr (e, shdr.sh_link, (size_t) es->st_name);
-                    if (name == NULL || *name == '\0') {
-                        continue;
+                if (GELF_ST_TYPE (es->st_info) != STT_OBJECT &&
+                    GELF_ST_VISIBILITY (es->st_info) != STV_DEFAULT) {
+                    continue;
+                }
+                name = elf_strptr (e, shdr.sh_link, (size_t) es->st_name);
+                if (name == NULL || *name == '\0') {
+                    continue;
+                }
+                /* put the symbol and info into the symbol hash table */
+                {
+                    globalvar_t *gv = (globalvar_t *) malloc (sizeof (*gv));
+                    if (gv == NULL) {
+                        goto bail;
                     }
-                    /* put the symbol and info into the symbol hash table */
-                    {
-                        globalvar_t *gv = (globalvar_t *) malloc (sizeof (*gv));
-                        if (gv == NULL) {
-                            goto bail;
-                        }
-                        gv->name = strdup (name);
-                        if (gv->name == NULL) {
-                            free (gv);
-                            goto bail;
-                        }
-                        gv->addr = (void *) es->st_value;
-                        gv->size = es->st_size;
-                        HASH_ADD_PTR (gvp, addr, gv);
+                    gv->name = strdup (name);
+                    if (gv->name == NULL) {
+                        free (gv);
+                        goto bail;
                     }
+                    gv->addr = (void *) es->st_value;
+                    gv->size = es->st_size;
+                    HASH_ADD_PTR (gvp, addr, gv);
                 }
             }
-            /*
-             * pulled out all the global symbols => success,
-             * don't need to scan further
-             */
-            ret = 0;
-            break;
         }
+        /*
+         * pulled out all the global symbols => success,
+         * don't need to scan further
+         */
+        ret = 0;
+        break;
     }
 
   bail:
@@ -286,17 +340,207 @@ table_init_helper (void)
     return ret;
 }
 
-/* ======================================================================== */
+/*
+ * called for each loaded object: record its loadable segments with
+ * data in, i.e. those that aren't code
+ */
+static int
+dso_area_add (struct dl_phdr_info *info, size_t size, void *data)
+{
+    int i;
+
+    /* the executable comes first, and we already have its areas */
+    if ((info->dlpi_name == NULL) || (*info->dlpi_name == '\0')) {
+        return 0;
+        /* NOT REACHED */
+    }
+
+    for (i = 0; i < info->dlpi_phnum; i += 1) {
+        const ElfW (Phdr) * php = &info->dlpi_phdr[i];
+        global_area_t *ga;
+
+        if ((php->p_type != PT_LOAD) ||
+            (php->p_flags & PF_X) || (php->p_memsz == 0)) {
+            continue;
+        }
 
-#if 0
+        if (dso_nareas == dso_maxareas) {
+            const int n = (dso_maxareas == 0) ? 16 : 2 * dso_maxareas;
+
+            ga = (global_area_t *) realloc (dso_areas, n * sizeof (*ga));
+            if (ga == NULL) {
+                return -1;      /* stops the walk */
+                /* NOT REACHED */
+            }
+            dso_areas = ga;
+            dso_maxareas = n;
+        }
+
+        ga = &dso_areas[dso_nareas];
+        ga->start = (size_t) (info->dlpi_addr + php->p_vaddr);
+        ga->end = ga->start + php->p_memsz;
+        dso_nareas += 1;
+
+        shmemi_trace (SHMEM_LOG_SYMBOLS,
+                      "%s for global variables = 0x%lX -> 0x%lX",
+                      info->dlpi_name, ga->start, ga->end);
+    }
+
+    return 0;
+}
+
+static int
+area_compare (const void *p1, const void *p2)
+{
+    const global_area_t *a1 = (const global_area_t *) p1;
+    const global_area_t *a2 = (const global_area_t *) p2;
+
+    return (a1->start > a2->start) - (a1->start < a2->start);
+}
 
 /*
- * helpers for debug output: not used currently
+ * find the shared objects' areas, and keep the ones that are at the
+ * same address on all PEs.  Objects are walked in load order, which
+ * is the same everywhere if the same objects are loaded, so the
+ * areas can be compared position by position.
+ *
+ * One max reduction over each area's start and end, and their
+ * complements, gives every PE the largest and smallest values; an
+ * area is symmetric if both are its own.  Addresses are compared in
+ * full: a near miss would send puts to the wrong place.
+ */
+void
+shmemi_symmetric_globalvar_dso_init (void)
+{
+    int nvals;
+    int nwrk;
+    long *scratch;
+    long *source;
+    long *target;
+    long *pwrk;
+    long *psync;
+    int kept = 0;
+    int i;
+
+    if (dl_iterate_phdr (dso_area_add, NULL) != 0) {
+        dso_nareas = 0;         /* agree on nothing below */
+    }
+
+    /* all the same objects? */
+    if (! shmemi_comms_barrier_all_same (dso_nareas)) {
+        shmemi_trace (SHMEM_LOG_INIT,
+                      "PEs have different shared objects loaded,"
+                      " globals in them aren't symmetric");
+        dso_nareas = 0;
+        return;
+        /* NOT REACHED */
+    }
+    if (dso_nareas == 0) {
+        return;
+        /* NOT REACHED */
+    }
+
+    nvals = 4 * dso_nareas;
+    nwrk = ((nvals / 2 + 1) > SHMEM_REDUCE_MIN_WRKDATA_SIZE) ?
+        (nvals / 2 + 1) : SHMEM_REDUCE_MIN_WRKDATA_SIZE;
+
+    /* same size everywhere now, so the heap stays symmetric */
+    scratch = (long *) shmemi_mem_alloc ((2 * nvals + nwrk +
+                                          SHMEM_REDUCE_SYNC_SIZE) *
+                                         sizeof (long));
+    if (EXPR_UNLIKELY (scratch == (long *) NULL)) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "internal error: couldn't allocate"
+                      " memory to compare shared object areas");
+        return;
+        /* NOT REACHED */
+    }
+    source = scratch;
+    target = source + nvals;
+    pwrk = target + nvals;
+    psync = pwrk + nwrk;
+
+    for (i = 0; i < SHMEM_REDUCE_SYNC_SIZE; i += 1) {
+        psync[i] = SHMEM_SYNC_VALUE;
+    }
+    for (i = 0; i < dso_nareas; i += 1) {
+        source[4 * i + 0] = (long) dso_areas[i].start;
+        source[4 * i + 1] = ~(long) dso_areas[i].start;
+        source[4 * i + 2] = (long) dso_areas[i].end;
+        source[4 * i + 3] = ~(long) dso_areas[i].end;
+    }
+
+    /* no-one may use my pSync before it is set */
+    shmem_barrier_all ();
+
+    shmem_long_max_to_all (target, source, nvals,
+                           0, 0, GET_STATE (numpes), pwrk, psync);
+
+    /* every PE gets the same answers, so keeps the same areas */
+    for (i = 0; i < dso_nareas; i += 1) {
+        const int same =
+            (target[4 * i + 0] == source[4 * i + 0]) &&
+            (target[4 * i + 1] == source[4 * i + 1]) &&
+            (target[4 * i + 2] == source[4 * i + 2]) &&
+            (target[4 * i + 3] == source[4 * i + 3]);
+
+        if (same) {
+            dso_areas[kept] = dso_areas[i];
+            kept += 1;
+        }
+    }
+
+    /* everyone has to be done reading my source before it's reused */
+    shmem_barrier_all ();
+    shmemi_mem_free (scratch);
+
+    if (kept < dso_nareas) {
+        shmemi_trace (SHMEM_LOG_INIT,
+                      "%d of %d shared object areas are at the same"
+                      " address on all PEs",
+                      kept, dso_nareas);
+    }
+    dso_nareas = kept;
+
+    qsort (dso_areas, dso_nareas, sizeof (*dso_areas), area_compare);
+}
+
+/*
+ * look for "a" in the shared objects' areas
+ */
+static inline int
+dso_is_globalvar (size_t a)
+{
+    int lo = 0;
+    int hi = dso_nareas - 1;
+
+    while (lo <= hi) {
+        const int mid = (lo + hi) / 2;
+
+        if (a < dso_areas[mid].start) {
+            hi = mid - 1;
+        }
+        else if (a >= dso_areas[mid].end) {
+            lo = mid + 1;
+        }
+        else {
+            return 1;
+            /* NOT REACHED */
+        }
+    }
+
+    return 0;
+}
+
+/* ======================================================================== */
+
+/*
+ * helpers for debug output
  */
 static int
 addr_sort (globalvar_t * a, globalvar_t * b)
 {
-    return ((char *) (a->addr) - (char *) (b->addr));
+    return (a->addr > b->addr) - (a->addr < b->addr);
 }
 
 static void
@@ -322,10 +566,10 @@ print_global_var_table (shmem_trace_t msgtype)
     shmemi_trace (msgtype, "-- end hash table --");
 }
 
-#endif /* 0: unused debugging routines */
-
 /*
- * read in the symbol table and global data areas
+ * read in the global data areas of the executable.  The symbol table
+ * is only read if someone wants to see it.  Shared objects are done
+ * later, once the collectives can compare them.
  */
 void
 shmemi_symmetric_globalvar_table_init (void)
@@ -333,12 +577,18 @@ shmemi_symmetric_globalvar_table_init (void)
     if (table_init_helper () != 0) {
         shmemi_trace (SHMEM_LOG_FATAL,
                       "internal error: couldn't read"
-                      " global symbols in executable");
+                      " global data areas in executable");
         return;
         /* NOT REACHED */
     }
 
-    /* print_global_var_table(SHMEM_LOG_SYMBOLS); */
+    if (shmemi_trace_is_enabled (SHMEM_LOG_SYMBOLS)) {
+        if (symbols_init_helper () != 0) {
+            shmemi_trace (SHMEM_LOG_SYMBOLS,
+                          "couldn't read global symbols in executable");
+        }
+        print_global_var_table (SHMEM_LOG_SYMBOLS);
+    }
 }
 
 /*
@@ -353,7 +603,12 @@ shmemi_symmetric_globalvar_table_finalize (void)
     HASH_ITER (hh, gvp, current, tmp) {
         free (current->name);   /* was strdup'ed above */
         HASH_DEL (gvp, current);
+        free (current);
     }
+
+    free (dso_areas);
+    dso_areas = NULL;
+    dso_nareas = dso_maxareas = 0;
 }
 
 /*
@@ -377,6 +632,6 @@ shmemi_symmetric_is_globalvar (const void *addr)
         return 1;
     }
     else {
-        return 0;
+        return dso_is_globalvar (a);
     }
 }
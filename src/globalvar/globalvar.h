@@ -60,6 +60,7 @@
 extern int shmemi_symmetric_is_globalvar (const void *addr);
 
 extern void shmemi_symmetric_globalvar_table_init (void);
+extern void shmemi_symmetric_globalvar_dso_init (void);
 extern void shmemi_symmetric_globalvar_table_finalize (void);
 
 #endif /* _GLOBALVAR_H */
@@ -0,0 +1,238 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#if defined(HAVE_FEATURE_EXPERIMENTAL)
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "state.h"
+#include "trace.h"
+#include "utils.h"
+
+#include "shmem.h"
+#include "shmemx.h"
+
+#ifdef HAVE_FEATURE_PSHMEM
+#include "pshmemx.h"
+#endif /* HAVE_FEATURE_PSHMEM */
+
+/*
+ * alignment when the caller doesn't ask for one, as malloc gives
+ */
+#define ARENA_DEFAULT_ALIGN 16
+
+/*
+ * the block itself is aligned to this, so that aligning offsets in
+ * it aligns addresses on every PE alike
+ */
+#define ARENA_MAX_ALIGN 4096
+
+/*
+ * an arena is one symmetric allocation handed out from the bottom
+ * up.  The handle is local: only the block is symmetric.
+ */
+struct shmemi_arena
+{
+    char *base;                 /* symmetric block */
+    size_t size;                /* its size */
+    size_t used;                /* next free byte */
+    size_t high;                /* most ever used, for reports */
+    unsigned long nallocs;      /* allocations since last reset */
+};
+
+#ifdef HAVE_FEATURE_PSHMEM
+#pragma weak shmemx_arena_create = pshmemx_arena_create
+#define shmemx_arena_create pshmemx_arena_create
+#pragma weak shmemx_arena_alloc = pshmemx_arena_alloc
+#define shmemx_arena_alloc pshmemx_arena_alloc
+#pragma weak shmemx_arena_reset = pshmemx_arena_reset
+#define shmemx_arena_reset pshmemx_arena_reset
+#pragma weak shmemx_arena_destroy = pshmemx_arena_destroy
+#define shmemx_arena_destroy pshmemx_arena_destroy
+#endif /* HAVE_FEATURE_PSHMEM */
+
+/**
+ * collectively create an arena of "size" bytes of symmetric memory
+ */
+shmemx_arena_t
+shmemx_arena_create (size_t size)
+{
+    shmemx_arena_t a;
+
+    DEBUG_NAME ("shmemx_arena_create");
+    INIT_CHECK (debug_name);
+
+    a = (shmemx_arena_t) malloc (sizeof (*a));
+    if (EXPR_UNLIKELY (a == SHMEMX_ARENA_INVALID)) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "internal error: unable to allocate arena");
+        return SHMEMX_ARENA_INVALID;
+        /* NOT REACHED */
+    }
+
+    /* everyone has the block once this returns */
+    a->base = (char *) shmem_align (ARENA_MAX_ALIGN, size);
+    if (EXPR_UNLIKELY (a->base == (char *) NULL)) {
+        shmemi_trace (SHMEM_LOG_NOTICE,
+                      "unable to create arena of %lu bytes",
+                      (unsigned long) size);
+        free (a);
+        return SHMEMX_ARENA_INVALID;
+        /* NOT REACHED */
+    }
+
+    a->size = size;
+    a->used = 0;
+    a->high = 0;
+    a->nallocs = 0;
+
+    shmemi_trace (SHMEM_LOG_MEMORY,
+                  "arena of %lu bytes @ %p",
+                  (unsigned long) size, a->base);
+
+    return a;
+}
+
+/**
+ * hand out the next "size" bytes of "arena", aligned to "align".  No
+ * communication: symmetric as long as every PE asks for the same
+ * blocks in the same order.
+ */
+void *
+shmemx_arena_alloc (shmemx_arena_t arena, size_t size, size_t align)
+{
+    size_t off;
+
+    if (EXPR_UNLIKELY (arena == SHMEMX_ARENA_INVALID)) {
+        return NULL;
+    }
+    if (align == 0) {
+        align = ARENA_DEFAULT_ALIGN;
+    }
+    else if (EXPR_UNLIKELY (((align & (align - 1)) != 0) ||
+                            (align > ARENA_MAX_ALIGN))) {
+        shmemi_trace (SHMEM_LOG_NOTICE,
+                      "arena alignment %lu is not a power of 2"
+                      " up to %d",
+                      (unsigned long) align, ARENA_MAX_ALIGN);
+        return NULL;
+    }
+
+    off = (arena->used + align - 1) & ~(align - 1);
+
+    if (EXPR_UNLIKELY ((off > arena->size) || (size > arena->size - off))) {
+        shmemi_trace (SHMEM_LOG_MEMORY,
+                      "arena @ %p can't fit %lu more bytes",
+                      arena->base, (unsigned long) size);
+        return NULL;
+    }
+
+    arena->used = off + size;
+    if (arena->used > arena->high) {
+        arena->high = arena->used;
+    }
+    arena->nallocs += 1;
+
+    return arena->base + off;
+}
+
+/**
+ * collectively release everything allocated from "arena"
+ */
+void
+shmemx_arena_reset (shmemx_arena_t arena)
+{
+    DEBUG_NAME ("shmemx_arena_reset");
+    INIT_CHECK (debug_name);
+
+    if (EXPR_UNLIKELY (arena == SHMEMX_ARENA_INVALID)) {
+        return;
+    }
+
+    /* nobody is still using the blocks once we're all here */
+    shmem_barrier_all ();
+
+    shmemi_trace (SHMEM_LOG_MEMORY,
+                  "arena @ %p reset after %lu allocations,"
+                  " %lu of %lu bytes used",
+                  arena->base, arena->nallocs,
+                  (unsigned long) arena->used, (unsigned long) arena->size);
+
+    arena->used = 0;
+    arena->nallocs = 0;
+}
+
+/**
+ * collectively give the arena back to the symmetric heap
+ */
+void
+shmemx_arena_destroy (shmemx_arena_t arena)
+{
+    DEBUG_NAME ("shmemx_arena_destroy");
+    INIT_CHECK (debug_name);
+
+    if (EXPR_UNLIKELY (arena == SHMEMX_ARENA_INVALID)) {
+        return;
+    }
+
+    shmemi_trace (SHMEM_LOG_MEMORY,
+                  "arena @ %p destroyed, at most %lu of %lu bytes used",
+                  arena->base,
+                  (unsigned long) arena->high, (unsigned long) arena->size);
+
+    /* shmem_free synchronizes before releasing the block */
+    shmem_free (arena->base);
+    free (arena);
+}
+
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
@@ -51,16 +51,40 @@
 
 #ifdef HAVE_FEATURE_DEBUG
 
-#include "uthash.h"
+#include <stdlib.h>
+#include <stdint.h>
 
 #include "trace.h"
 
 #include "debug_alloc.h"
 
-static alloc_table_t *atp = NULL;   /* our allocation hash table */
+/*
+ * Allocations are kept in a treap: a binary search tree on address
+ * that is also a heap on a priority hashed from the address, which
+ * keeps it balanced (in expectation) whatever order the allocations
+ * come in.  Allocations don't overlap, so the one holding an address
+ * is the one with the highest start at or below it.
+ */
+
+static alloc_table_t *atp = NULL;   /* root of our allocation tree */
+
+/**
+ * pseudo-random priority for address A
+ */
+
+static inline unsigned long
+debug_alloc_prio (void *a)
+{
+    uint64_t x = (uint64_t) (uintptr_t) a;
+
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return (unsigned long) x;
+}
 
 /**
- * create a new hash entry with address A and size S
+ * create a new tree entry with address A and size S
  */
 
 static inline alloc_table_t *
@@ -77,19 +101,68 @@ debug_alloc_new (void *a, size_t s)
     }
     at->addr = a;
     at->size = s;
+    at->prio = debug_alloc_prio (a);
+    at->left = at->right = NULL;
     return at;
 }
 
 /**
- * locate hash table entry for address A
+ * split tree T into entries below address A (into *LP) and the rest
+ * (into *RP)
+ */
+
+static void
+debug_alloc_split (alloc_table_t *t, void *a,
+                   alloc_table_t **lp, alloc_table_t **rp)
+{
+    if (t == NULL) {
+        *lp = *rp = NULL;
+    }
+    else if (t->addr < a) {
+        debug_alloc_split (t->right, a, &(t->right), rp);
+        *lp = t;
+    }
+    else {
+        debug_alloc_split (t->left, a, lp, &(t->left));
+        *rp = t;
+    }
+}
+
+/**
+ * join trees L and R, where everything in L is below everything in R
+ */
+
+static alloc_table_t *
+debug_alloc_merge (alloc_table_t *l, alloc_table_t *r)
+{
+    if (l == NULL) {
+        return r;
+    }
+    if (r == NULL) {
+        return l;
+    }
+    if (l->prio > r->prio) {
+        l->right = debug_alloc_merge (l->right, r);
+        return l;
+    }
+    else {
+        r->left = debug_alloc_merge (l, r->left);
+        return r;
+    }
+}
+
+/**
+ * locate tree entry for address A
  */
 
 void *
 debug_alloc_find (void *a)
 {
-    alloc_table_t *at = NULL;   /* entry corresponding to "a" */
+    alloc_table_t *at = atp;
 
-    HASH_FIND_PTR (atp, &a, at);
+    while ((at != NULL) && (at->addr != a)) {
+        at = (a < at->addr) ? at->left : at->right;
+    }
     return at;
 }
 
@@ -97,9 +170,6 @@ debug_alloc_find (void *a)
  * does address A lie within a known allocation in the symmetric heap?
  * Return 1 if so, 0 if not.
  *
- * TODO: is there a better-than-linear way of discovering this?  Some
- * tree-based or inverted-map approach?
- *
  * TODO: we can also take the put/get parameters and do a full check
  * on the extent of the call.  Strided could be a weirdness.
  */
@@ -107,19 +177,24 @@ debug_alloc_find (void *a)
 int
 debug_alloc_check (void *a)
 {
-    alloc_table_t *tmp;
-    alloc_table_t *s;
+    alloc_table_t *at = atp;
+    alloc_table_t *below = NULL;    /* highest start at or below "a" */
 
-    HASH_ITER (hh, atp, s, tmp) {
-        const size_t off = a - s->addr;
-
-        /* if ( (s->size > off) && (off >= 0) ) */
-        if (s->size > off) {
-            return 1;
-            /* NOT REACHED */
+    while (at != NULL) {
+        if (at->addr <= a) {
+            below = at;
+            at = at->right;
+        }
+        else {
+            at = at->left;
         }
     }
 
+    if ((below != NULL) && ((size_t) (a - below->addr) < below->size)) {
+        return 1;
+        /* NOT REACHED */
+    }
+
     shmemi_trace (SHMEM_LOG_MEMORY,
                   "address %p is not in a known symmetric allocation", a);
     return 0;
@@ -127,56 +202,88 @@ debug_alloc_check (void *a)
 
 /**
  * when we allocate anew, add entry for address A and size S to the
- * table
+ * tree
  */
 
 void
 debug_alloc_add (void *a, size_t s)
 {
-    alloc_table_t *at = debug_alloc_new (a, s);
+    alloc_table_t *at;
+    alloc_table_t *l;
+    alloc_table_t *r;
+
+    /* failed allocation, nothing to record */
+    if (a == NULL) {
+        return;
+    }
 
-    HASH_ADD_PTR (atp, addr, at);
+    at = debug_alloc_new (a, s);
+    if (at == NULL) {
+        return;
+    }
+
+    debug_alloc_split (atp, a, &l, &r);
+    atp = debug_alloc_merge (debug_alloc_merge (l, at), r);
 }
 
 /**
- * when data is freed, remove from hash table
+ * when data is freed, remove from tree
  */
 
 void
 debug_alloc_del (void *a)
 {
-    alloc_table_t *at = debug_alloc_find (a);
+    alloc_table_t *l;
+    alloc_table_t *at;
+    alloc_table_t *r;
+
+    debug_alloc_split (atp, a, &l, &r);
+    /* "a" is the lowest address in r, if it's there at all */
+    debug_alloc_split (r, (char *) a + 1, &at, &r);
+
+    atp = debug_alloc_merge (l, r);
 
     if (at == NULL) {
         shmemi_trace (SHMEM_LOG_FATAL,
-                      "internal error: no hash table entry for address %p", a);
+                      "internal error: no tree entry for address %p", a);
         return;
         /* NOT REACHED */
     }
-    HASH_DEL (atp, at);
 
     free (at);
 }
 
 /**
- * when data realigned, replace existing hash table entry
+ * when data realigned, replace existing tree entry
  */
 
 void
 debug_alloc_replace (void *a, size_t s)
 {
-#if 1
-    /*
-     * TODO: could be a typo in HASH_REPLACE_PTR
-     * DONE: now fixed in uthash >= 1.9.9 (TC contributed fix)
-     */
-    alloc_table_t *at = debug_alloc_new (a, s);
-    alloc_table_t *replaced_stub;
-    HASH_REPLACE_PTR (atp, addr, at, replaced_stub);
-#else
-    debug_alloc_del (a);
-    debug_alloc_add (a, s);
-#endif
+    alloc_table_t *at = debug_alloc_find (a);
+
+    if (at != NULL) {
+        at->size = s;
+    }
+    else {
+        debug_alloc_add (a, s);
+    }
+}
+
+/**
+ * walk tree T in address order
+ */
+
+static void
+debug_alloc_dump_tree (alloc_table_t *t)
+{
+    if (t == NULL) {
+        return;
+    }
+    debug_alloc_dump_tree (t->left);
+    shmemi_trace (SHMEM_LOG_MEMORY,
+                  "addr = %p, size = %ld", t->addr, t->size);
+    debug_alloc_dump_tree (t->right);
 }
 
 /**
@@ -186,13 +293,7 @@ debug_alloc_replace (void *a, size_t s)
 void
 debug_alloc_dump (void)
 {
-    alloc_table_t *tmp;
-    alloc_table_t *s;
-
-    HASH_ITER (hh, atp, s, tmp) {
-        shmemi_trace (SHMEM_LOG_MEMORY,
-                      "addr = %p, size = %ld", s->addr, s->size);
-    }
+    debug_alloc_dump_tree (atp);
 }
 
 #endif /* HAVE_FEATURE_DEBUG */
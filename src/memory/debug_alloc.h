@@ -56,13 +56,13 @@
 
 #  include <sys/types.h>
 
-#  include "uthash.h"
-
-typedef struct
+typedef struct alloc_table
 {
   void *addr;            /* key: shmalloc'ed address to be recorded */
   size_t size;           /* how many bytes */
-  UT_hash_handle hh;     /* structure is hashable */
+  unsigned long prio;    /* keeps the tree balanced */
+  struct alloc_table *left;     /* lower addresses */
+  struct alloc_table *right;    /* higher addresses */
 } alloc_table_t;
 
 
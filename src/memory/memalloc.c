@@ -55,15 +55,537 @@
  * This is PE-local and sits just below SHMEM itself.
  */
 
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+#include "utils.h"
+
+#include "shmemx.h"
+
+#include "memalloc.h"
 #include "debug_alloc.h"
 
 #include "dlmalloc.h"
 
 
+/*
+ * The heap can be made of several segments, each managed by its own
+ * mspace.  They're kept in the order they were added, which is the
+ * same on all PEs, and indexed by address for lookups.
+ *
+ */
+typedef struct
+{
+    uintptr_t base;
+    size_t size;
+    mspace space;
+
+    /*
+     * the slab starting in each SLAB_BYTES window of the pool,
+     * counted from its base, so free() can tell a slab object from
+     * a dlmalloc chunk
+     */
+    struct slab **slab_map;
+} pool_t;
+
+static pool_t pools[MEM_MAX_POOLS];
+static pool_t *by_addr[MEM_MAX_POOLS];
+static int npools = 0;
+
+/*
+ * Small requests are served from slabs: SLAB_BYTES chunks of the
+ * pools, each cut into objects of one size class.  The classes are powers of 2 from SLAB_MIN_SIZE to
+ * SLAB_MAX_SIZE; anything bigger goes straight to dlmalloc.
+ *
+ * Everything here depends only on the order of the allocation calls,
+ * which is the same on all PEs, so the slabs and the objects handed
+ * out stay symmetric.  Slabs are plain dlmalloc chunks, not aligned
+ * ones: segments needn't start at the same address modulo anything
+ * on all PEs, and memalign would put them at different offsets.
+ *
+ */
+
+#define SLAB_SHIFT 15
+#define SLAB_BYTES (1UL << SLAB_SHIFT)
+
+#define SLAB_MIN_SHIFT 4
+#define SLAB_MIN_SIZE (1UL << SLAB_MIN_SHIFT)
+#define SLAB_MAX_SIZE 4096UL
+#define SLAB_NCLASSES 9         /* 16 .. 4096 */
+
+/* header at the start of each slab, objects start after it */
+#define SLAB_HEADER 64
+
+typedef struct slab
+{
+    struct slab *prev;          /* partially used slabs of this class */
+    struct slab *next;
+    void *free;                 /* free objects, linked through their
+                                   first word */
+    unsigned int nfree;
+    unsigned int cls;
+} slab_t;
+
+typedef struct
+{
+    slab_t *partial;            /* slabs with at least one free object */
+    unsigned int nslabs;
+    unsigned int nobjs;         /* objects per slab */
+    unsigned long inuse;        /* objects handed out */
+    unsigned long allocs;       /* total allocations served */
+} slab_class_t;
+
+static slab_class_t classes[SLAB_NCLASSES];
+
+/*
+ * what the program has allocated, in whole blocks
+ */
+static size_t bytes_inuse = 0;
+static size_t bytes_peak = 0;
+static unsigned long nallocs = 0;
+static unsigned long nblocks = 0;
+
+static inline void
+stats_add (size_t n)
+{
+    bytes_inuse += n;
+    if (bytes_inuse > bytes_peak) {
+        bytes_peak = bytes_inuse;
+    }
+    nallocs += 1;
+    nblocks += 1;
+}
+
+static inline void
+stats_del (size_t n)
+{
+    bytes_inuse -= n;
+    nblocks -= 1;
+}
+
+static inline void
+stats_resize (size_t old_n, size_t new_n)
+{
+    bytes_inuse = bytes_inuse - old_n + new_n;
+    if (bytes_inuse > bytes_peak) {
+        bytes_peak = bytes_inuse;
+    }
+}
+
+static inline size_t
+class_size (int c)
+{
+    return SLAB_MIN_SIZE << c;
+}
+
 /**
- * the memory area we manage in this unit.  Not visible to anyone else
+ * smallest class holding SIZE bytes, or -1 if it's too big
  */
-static mspace myspace;
+static inline int
+size_to_class (size_t size)
+{
+    int c = 0;
+
+    if (size > SLAB_MAX_SIZE) {
+        return -1;
+    }
+    while (class_size (c) < size) {
+        c += 1;
+    }
+    return c;
+}
+
+/**
+ * the pool holding ADDR, or NULL if it's not in the heap
+ */
+static inline pool_t *
+addr_to_pool (void *addr)
+{
+    const uintptr_t a = (uintptr_t) addr;
+    int lo = 0;
+    int hi = npools - 1;
+
+    while (lo <= hi) {
+        const int mid = (lo + hi) / 2;
+        pool_t *pp = by_addr[mid];
+
+        if (a < pp->base) {
+            hi = mid - 1;
+        }
+        else if (a >= pp->base + pp->size) {
+            lo = mid + 1;
+        }
+        else {
+            return pp;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * the slab holding ADDR in pool PP, or NULL if ADDR came from dlmalloc.
+ * A slab spans at most 2 windows, so it's either the one starting in
+ * ADDR's window at or below ADDR, or the one starting in the window
+ * before if it reaches ADDR.
+ */
+static inline slab_t *
+addr_to_slab (pool_t *pp, void *addr)
+{
+    const uintptr_t a = (uintptr_t) addr;
+    size_t w;
+    slab_t *sp;
+
+    if (EXPR_UNLIKELY (pp == NULL)) {
+        return NULL;
+    }
+
+    w = (a - pp->base) >> SLAB_SHIFT;
+
+    sp = pp->slab_map[w];
+    if ((sp != NULL) && (a >= (uintptr_t) sp)) {
+        return sp;
+    }
+    if (w > 0) {
+        sp = pp->slab_map[w - 1];
+        if ((sp != NULL) && (a < (uintptr_t) sp + SLAB_BYTES)) {
+            return sp;
+        }
+    }
+    return NULL;
+}
+
+static inline void
+set_map (slab_t *sp, slab_t *v)
+{
+    pool_t *pp = addr_to_pool (sp);
+
+    pp->slab_map[((uintptr_t) sp - pp->base) >> SLAB_SHIFT] = v;
+}
+
+/**
+ * first fit over the pools, in the order they were added
+ */
+static void *
+pools_malloc (size_t size)
+{
+    int i;
+
+    for (i = 0; i < npools; i += 1) {
+        void *addr = mspace_malloc (pools[i].space, size);
+
+        if (addr != NULL) {
+            return addr;
+        }
+    }
+    return NULL;
+}
+
+static void *
+pools_memalign (size_t alignment, size_t size)
+{
+    int i;
+
+    for (i = 0; i < npools; i += 1) {
+        void *addr = mspace_memalign (pools[i].space, alignment, size);
+
+        if (addr != NULL) {
+            return addr;
+        }
+    }
+    return NULL;
+}
+
+static inline void
+partial_add (slab_class_t *cp, slab_t *sp)
+{
+    sp->prev = NULL;
+    sp->next = cp->partial;
+    if (cp->partial != NULL) {
+        cp->partial->prev = sp;
+    }
+    cp->partial = sp;
+}
+
+static inline void
+partial_remove (slab_class_t *cp, slab_t *sp)
+{
+    if (sp->prev != NULL) {
+        sp->prev->next = sp->next;
+    }
+    else {
+        cp->partial = sp->next;
+    }
+    if (sp->next != NULL) {
+        sp->next->prev = sp->prev;
+    }
+}
+
+/**
+ * carve a new slab for class C out of the pools
+ */
+static slab_t *
+slab_new (int c)
+{
+    slab_class_t *cp = &classes[c];
+    const size_t sz = class_size (c);
+    slab_t *sp;
+    char *obj;
+    unsigned int i;
+
+    sp = (slab_t *) pools_malloc (SLAB_BYTES);
+    if (EXPR_UNLIKELY (sp == (slab_t *) NULL)) {
+        return NULL;
+    }
+
+    sp->cls = c;
+    sp->nfree = cp->nobjs;
+    sp->free = NULL;
+    /* thread from the top down, so objects go out in address order */
+    obj = (char *) sp + SLAB_HEADER + (cp->nobjs - 1) * sz;
+    for (i = 0; i < cp->nobjs; i += 1) {
+        *(void **) obj = sp->free;
+        sp->free = obj;
+        obj -= sz;
+    }
+
+    set_map (sp, sp);
+    partial_add (cp, sp);
+    cp->nslabs += 1;
+
+    shmemi_trace (SHMEM_LOG_MEMORY,
+                  "new %ld-byte slab @ %p", (long) sz, sp);
+
+    return sp;
+}
+
+static void *
+slab_alloc (int c)
+{
+    slab_class_t *cp = &classes[c];
+    slab_t *sp = cp->partial;
+    void *obj;
+
+    if (sp == NULL) {
+        sp = slab_new (c);
+        if (EXPR_UNLIKELY (sp == (slab_t *) NULL)) {
+            return NULL;
+        }
+    }
+
+    obj = sp->free;
+    sp->free = *(void **) obj;
+    sp->nfree -= 1;
+    if (sp->nfree == 0) {
+        partial_remove (cp, sp);
+    }
+
+    cp->inuse += 1;
+    cp->allocs += 1;
+
+    return obj;
+}
+
+/**
+ * put ADDR back in its slab.  An empty slab goes back to dlmalloc,
+ * unless it's the last one of its class.
+ */
+static void
+slab_free (pool_t *pp, slab_t *sp, void *addr)
+{
+    slab_class_t *cp = &classes[sp->cls];
+
+    *(void **) addr = sp->free;
+    sp->free = addr;
+    sp->nfree += 1;
+    cp->inuse -= 1;
+
+    if (sp->nfree == 1) {
+        partial_add (cp, sp);
+    }
+    if ((sp->nfree == cp->nobjs) && (cp->nslabs > 1)) {
+        partial_remove (cp, sp);
+        set_map (sp, NULL);
+        cp->nslabs -= 1;
+        mspace_free (pp->space, sp);
+    }
+}
+
+/**
+ * report slab usage per size class
+ */
+static void
+slab_report (void)
+{
+    int c;
+
+    for (c = 0; c < SLAB_NCLASSES; c += 1) {
+        const slab_class_t *cp = &classes[c];
+
+        if (cp->allocs == 0) {
+            continue;
+        }
+        shmemi_trace (SHMEM_LOG_MEMORY,
+                      "size class %ld: %u slab%s, %lu in use,"
+                      " %lu allocations",
+                      (long) class_size (c),
+                      cp->nslabs, (cp->nslabs == 1) ? "" : "s",
+                      cp->inuse, cp->allocs);
+    }
+}
+
+/**
+ * allocate without the debug bookkeeping
+ */
+static void *
+mem_alloc (size_t size)
+{
+    const int c = size_to_class (size);
+    void *addr;
+
+    if (c >= 0) {
+        addr = slab_alloc (c);
+        if (addr != NULL) {
+            stats_add (class_size (c));
+        }
+    }
+    else {
+        addr = pools_malloc (size);
+        if (addr != NULL) {
+            stats_add (mspace_usable_size (addr));
+        }
+    }
+    return addr;
+}
+
+/**
+ * give back ADDR, from slab SP (if any) of pool PP
+ */
+static void
+mem_free (pool_t *pp, slab_t *sp, void *addr)
+{
+    if (sp != NULL) {
+        stats_del (class_size (sp->cls));
+        slab_free (pp, sp, addr);
+    }
+    else if (pp != NULL) {
+        stats_del (mspace_usable_size (addr));
+        mspace_free (pp->space, addr);
+    }
+}
+
+/**
+ * fill in usage of the whole heap
+ */
+void
+shmemi_mem_stats (struct shmemx_heap_stats *sp)
+{
+    int i;
+
+    sp->heap_size = 0;
+    sp->free = 0;
+    sp->largest_free = 0;
+
+    for (i = 0; i < npools; i += 1) {
+        size_t total, largest;
+
+        mspace_free_stats (pools[i].space, &total, &largest);
+        sp->heap_size += pools[i].size;
+        sp->free += total;
+        if (largest > sp->largest_free) {
+            sp->largest_free = largest;
+        }
+    }
+
+    /* unused objects in slabs are free too, if only for small blocks */
+    for (i = 0; i < SLAB_NCLASSES; i += 1) {
+        const slab_class_t *cp = &classes[i];
+
+        sp->free += ((unsigned long) cp->nslabs * cp->nobjs - cp->inuse)
+            * class_size (i);
+    }
+
+    sp->inuse = bytes_inuse;
+    sp->peak = bytes_peak;
+    sp->nallocs = nallocs;
+    sp->nblocks = nblocks;
+    sp->fragmentation = (sp->free > 0) ?
+        1.0 - ((double) sp->largest_free / (double) sp->free) : 0.0;
+}
+
+/**
+ * report heap usage
+ */
+static void
+mem_report (void)
+{
+    struct shmemx_heap_stats s;
+
+    shmemi_mem_stats (&s);
+
+    shmemi_trace (SHMEM_LOG_MEMORY,
+                  "symmetric heap: %lu of %lu bytes in use"
+                  " in %lu block%s, peak %lu",
+                  (unsigned long) s.inuse, (unsigned long) s.heap_size,
+                  s.nblocks, (s.nblocks == 1) ? "" : "s",
+                  (unsigned long) s.peak);
+    shmemi_trace (SHMEM_LOG_MEMORY,
+                  "symmetric heap: %lu allocations, %lu bytes free,"
+                  " largest free block %lu, fragmentation %.2f",
+                  s.nallocs, (unsigned long) s.free,
+                  (unsigned long) s.largest_free, s.fragmentation);
+}
+
+/**
+ * add the segment at BASE, CAPACITY bytes long, to the pool.  Returns
+ * non-zero on success.
+ */
+int
+shmemi_mem_add (void *base, size_t capacity)
+{
+    pool_t *pp;
+    size_t map_size;
+    int i;
+
+    if (EXPR_UNLIKELY (npools == MEM_MAX_POOLS)) {
+        shmemi_trace (SHMEM_LOG_MEMORY,
+                      "symmetric heap already has %d segments",
+                      MEM_MAX_POOLS);
+        return 0;
+    }
+
+    pp = &pools[npools];
+    pp->base = (uintptr_t) base;
+    pp->size = capacity;
+    pp->space = create_mspace_with_base (base, capacity, 1);
+    if (EXPR_UNLIKELY (pp->space == NULL)) {
+        return 0;
+    }
+
+    map_size = (capacity >> SLAB_SHIFT) + 1;
+    pp->slab_map = (slab_t **) calloc (map_size, sizeof (*pp->slab_map));
+    if (EXPR_UNLIKELY (pp->slab_map == NULL)) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "internal error: cannot allocate memory for"
+                      " slab map");
+        return 0;
+        /* NOT REACHED */
+    }
+
+    /* keep the address index sorted */
+    for (i = npools; (i > 0) && (by_addr[i - 1]->base > pp->base); i -= 1) {
+        by_addr[i] = by_addr[i - 1];
+    }
+    by_addr[i] = pp;
+    npools += 1;
+
+    shmemi_trace (SHMEM_LOG_MEMORY,
+                  "symmetric heap segment %d: %ld bytes @ %p",
+                  npools - 1, capacity, base);
+
+    return 1;
+}
 
 /**
  * initialize the memory pool
@@ -71,7 +593,18 @@ static mspace myspace;
 void
 shmemi_mem_init (void *base, size_t capacity)
 {
-    myspace = create_mspace_with_base (base, capacity, 1);
+    int c;
+
+    for (c = 0; c < SLAB_NCLASSES; c += 1) {
+        classes[c].partial = NULL;
+        classes[c].nslabs = 0;
+        classes[c].nobjs = (SLAB_BYTES - SLAB_HEADER) / class_size (c);
+        classes[c].inuse = 0;
+        classes[c].allocs = 0;
+    }
+
+    npools = 0;
+    shmemi_mem_add (base, capacity);
 }
 
 /**
@@ -80,7 +613,19 @@ shmemi_mem_init (void *base, size_t capacity)
 void
 shmemi_mem_finalize (void)
 {
-    destroy_mspace (myspace);
+    int i;
+
+    /* the stats walk every pool, so only gather them if they'll show */
+    if (shmemi_trace_is_enabled (SHMEM_LOG_MEMORY)) {
+        mem_report ();
+        slab_report ();
+    }
+
+    for (i = 0; i < npools; i += 1) {
+        destroy_mspace (pools[i].space);
+        free (pools[i].slab_map);
+    }
+    npools = 0;
 }
 
 /**
@@ -89,19 +634,16 @@ shmemi_mem_finalize (void)
 void *
 shmemi_mem_base (void)
 {
-    return myspace;
+    return pools[0].space;
 }
 
 /**
  * allocate SIZE bytes from the pool
  */
-
-#define MIN_MALLOC_SIZE 64
-
 void *
 shmemi_mem_alloc (size_t size)
 {
-    void *addr = mspace_malloc (myspace, size);
+    void *addr = mem_alloc (size);
 
 #ifdef HAVE_FEATURE_DEBUG
     debug_alloc_add (addr, size);
@@ -116,7 +658,10 @@ shmemi_mem_alloc (size_t size)
 void
 shmemi_mem_free (void *addr)
 {
-    mspace_free (myspace, addr);
+    pool_t *pp = addr_to_pool (addr);
+    slab_t *sp = addr_to_slab (pp, addr);
+
+    mem_free (pp, sp, addr);
 
 #ifdef HAVE_FEATURE_DEBUG
     debug_alloc_del (addr);
@@ -129,7 +674,40 @@ shmemi_mem_free (void *addr)
 void *
 shmemi_mem_realloc (void *addr, size_t new_size)
 {
-    void *new_addr = mspace_realloc (myspace, addr, new_size);
+    pool_t *pp = addr_to_pool (addr);
+    slab_t *sp = addr_to_slab (pp, addr);
+    void *new_addr;
+
+    if (pp == NULL) {
+        new_addr = mem_alloc (new_size);   /* realloc of NULL */
+    }
+    else if (sp == NULL) {
+        const size_t old_size = mspace_usable_size (addr);
+
+        new_addr = mspace_realloc (pp->space, addr, new_size);
+        if (new_addr != NULL) {
+            stats_resize (old_size, mspace_usable_size (new_addr));
+        }
+        else {
+            /* doesn't fit in its own segment, try the others */
+            new_addr = mem_alloc (new_size);
+            if (new_addr != NULL) {
+                memcpy (new_addr, addr,
+                        (old_size < new_size) ? old_size : new_size);
+                mem_free (pp, NULL, addr);
+            }
+        }
+    }
+    else if (new_size <= class_size (sp->cls)) {
+        new_addr = addr;        /* still fits */
+    }
+    else {
+        new_addr = mem_alloc (new_size);
+        if (new_addr != NULL) {
+            memcpy (new_addr, addr, class_size (sp->cls));
+            mem_free (pp, sp, addr);
+        }
+    }
 
 #ifdef HAVE_FEATURE_DEBUG
     debug_alloc_replace (addr, new_size);
@@ -144,7 +722,11 @@ shmemi_mem_realloc (void *addr, size_t new_size)
 void *
 shmemi_mem_align (size_t alignment, size_t size)
 {
-    void *aligned_addr = mspace_memalign (myspace, alignment, size);
+    void *aligned_addr = pools_memalign (alignment, size);
+
+    if (aligned_addr != NULL) {
+        stats_add (mspace_usable_size (aligned_addr));
+    }
 
 #ifdef HAVE_FEATURE_DEBUG
     debug_alloc_add (aligned_addr, size);
@@ -55,7 +55,18 @@
 
 #include <sys/types.h>
 
+/*
+ * most segments the symmetric heap can be made of
+ */
+#define MEM_MAX_POOLS 32
+
+/*
+ * segments are allocated on, and grown in, multiples of this
+ */
+#define MEM_SEGMENT_ALIGN (1UL << 15)
+
 extern void shmemi_mem_init (void *base, size_t capacity);
+extern int shmemi_mem_add (void *base, size_t capacity);
 extern void shmemi_mem_finalize (void);
 extern void *shmemi_mem_base (void);
 extern void *shmemi_mem_alloc (size_t size);
@@ -63,4 +74,7 @@ extern void shmemi_mem_free (void *addr);
 extern void *shmemi_mem_realloc (void *addr, size_t size);
 extern void *shmemi_mem_align (size_t alignment, size_t size);
 
+struct shmemx_heap_stats;
+extern void shmemi_mem_stats (struct shmemx_heap_stats *sp);
+
 #endif /* _MEMALLOC_H */
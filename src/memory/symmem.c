@@ -66,6 +66,13 @@
 #include "pshmem.h"
 #endif /* HAVE_FEATURE_PSHMEM */
 
+#ifdef HAVE_FEATURE_EXPERIMENTAL
+#include "shmemx.h"
+#ifdef HAVE_FEATURE_PSHMEM
+#include "pshmemx.h"
+#endif /* HAVE_FEATURE_PSHMEM */
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
+
 /*
  * Not present in SGI API any more.  I'm going to leave it in the
  * code, because Fortran needs it.  Removed from shmem.h.
@@ -76,60 +83,121 @@ long malloc_error = SHMEM_MALLOC_OK; /* exposed for error codes */
 
 #ifdef HAVE_FEATURE_DEBUG
 
+/*
+ * symmetric scratch space for the symmetry check, made on first use.
+ * Checks take turns with two of them, so back-to-back checks don't
+ * need a barrier in between.
+ */
+typedef struct
+{
+    long source[2];
+    long target[2];
+    long pwrk[SHMEM_REDUCE_MIN_WRKDATA_SIZE];
+    long psync[SHMEM_REDUCE_SYNC_SIZE];
+} symmetry_scratch_t;
+
+static symmetry_scratch_t *symmetry_scratch = NULL;
+static int symmetry_turn = 0;
+
+static int
+__shmalloc_symmetry_init (void)
+{
+    int t, i;
+
+    symmetry_scratch =
+        (symmetry_scratch_t *) shmemi_mem_alloc (2 *
+                                                 sizeof (*symmetry_scratch));
+    if (symmetry_scratch == (symmetry_scratch_t *) NULL) {
+        return 0;
+    }
+
+    for (t = 0; t < 2; t += 1) {
+        for (i = 0; i < SHMEM_REDUCE_SYNC_SIZE; i += 1) {
+            symmetry_scratch[t].psync[i] = SHMEM_SYNC_VALUE;
+        }
+    }
+
+    /* no-one may use my pSyncs before they are set */
+    shmem_barrier_all ();
+
+    return 1;
+}
+
+/**
+ * max over all PEs of the "n" values in "vals", result valid until
+ * the next-but-one call
+ */
+
+static long *
+__shmalloc_symmetry_max (const long *vals, int n)
+{
+    symmetry_scratch_t *sp = &symmetry_scratch[symmetry_turn];
+    int i;
+
+    symmetry_turn = 1 - symmetry_turn;
+
+    for (i = 0; i < n; i += 1) {
+        sp->source[i] = vals[i];
+    }
+    shmem_long_max_to_all (sp->target, sp->source, n,
+                           0, 0, GET_STATE (numpes), sp->pwrk, sp->psync);
+    return sp->target;
+}
+
 /**
  * check that all PEs see the same symmetric malloc size: return first
  * mis-matching PE id if there's a mis-match, return -1 to record
- * correct symmetry (no offending PE)
+ * correct symmetry (no offending PE).  Every PE gets the same answer.
+ *
+ * One reduction finds the largest and smallest sizes; only if they
+ * differ does a second one look for the culprit.
  */
 
 static inline int
 __shmalloc_symmetry_check (size_t size)
 {
-    int pe;
-    int any_failed_pe = -1;
-    long shmalloc_received_size;
-    long *shmalloc_remote_size;
-
-    /* record for everyone else to see */
-    shmalloc_remote_size =
-        (long *) shmemi_mem_alloc (sizeof (*shmalloc_remote_size));
-    if (shmalloc_remote_size == (long *) NULL) {
-        shmemi_trace (SHMEM_LOG_FATAL,
-                      "internal error: couldn't allocate"
-                      " memory for symmetry check");
-        return 0;               /* arbitrary PE number */
-        /* NOT REACHED */
+    const long s = (long) size;
+    long v[2];
+    long *r;
+
+    if (EXPR_UNLIKELY (symmetry_scratch == (symmetry_scratch_t *) NULL)) {
+        if (! __shmalloc_symmetry_init ()) {
+            shmemi_trace (SHMEM_LOG_FATAL,
+                          "internal error: couldn't allocate"
+                          " memory for symmetry check");
+            return 0;           /* arbitrary PE number */
+            /* NOT REACHED */
+        }
     }
-    *shmalloc_remote_size = size;
-    shmem_barrier_all ();
 
     malloc_error = SHMEM_MALLOC_OK;
 
-    /*
-     * everyone checks everyone else's sizes, barf if mis-match
-     *
-     * TODO: probably some kind of Eureka! optimization opportunity here
-     *
-     */
-    for (pe = 0; pe < GET_STATE (numpes); pe += 1) {
-        if (pe == GET_STATE (mype)) {
-            continue;
-        }
-        shmalloc_received_size = shmem_long_g (shmalloc_remote_size, pe);
-        if (shmalloc_received_size != size) {
-            shmemi_trace (SHMEM_LOG_NOTICE,
-                          "shmalloc expected %ld, but saw %ld on PE %d",
-                          size, shmalloc_received_size, pe);
-            malloc_error = SHMEM_MALLOC_SYMMSIZE_FAILED;
-            any_failed_pe = pe;
-            break;
-            /* NOT REACHED */
-        }
+    /* max of size and of -size */
+    v[0] = s;
+    v[1] = -s;
+    r = __shmalloc_symmetry_max (v, 2);
+    if (EXPR_LIKELY (r[0] == -r[1])) {
+        return -1;
+        /* NOT REACHED */
+    }
+
+    {
+        const long biggest = r[0];
+        const long smallest = -r[1];
+        int any_failed_pe;
+
+        /* lowest PE that didn't ask for the biggest size */
+        v[0] = (s != biggest) ? -GET_STATE (mype) : -GET_STATE (numpes);
+        r = __shmalloc_symmetry_max (v, 1);
+        any_failed_pe = (int) -r[0];
+
+        shmemi_trace (SHMEM_LOG_NOTICE,
+                      "shmalloc sizes range from %ld to %ld,"
+                      " first mis-match on PE %d (here %ld)",
+                      smallest, biggest, any_failed_pe, s);
+        malloc_error = SHMEM_MALLOC_SYMMSIZE_FAILED;
+        return any_failed_pe;
     }
-    /* make sure everyone is here before freeing things */
-    shmem_barrier_all ();
-    shmemi_mem_free (shmalloc_remote_size);
-    return any_failed_pe;
 }
 #endif /* HAVE_FEATURE_DEBUG */
 
@@ -147,6 +215,11 @@ __shmalloc_no_check (size_t size)
 
     addr = shmemi_mem_alloc (size);
 
+    /* out of heap: grow it (if allowed) and try again */
+    if ((addr == (void *) NULL) && shmemi_comms_heap_grow (size)) {
+        addr = shmemi_mem_alloc (size);
+    }
+
     if (addr == (void *) NULL) {
         shmemi_trace (SHMEM_LOG_NOTICE, "shmalloc(%ld bytes) failed", size);
         malloc_error = SHMEM_MALLOC_FAIL;
@@ -346,6 +419,11 @@ shrealloc_private (void *addr, size_t size)
 
     newaddr = shmemi_mem_realloc (addr, size);
 
+    /* the old block stays put if realloc fails, so grow and retry */
+    if ((newaddr == (void *) NULL) && shmemi_comms_heap_grow (size)) {
+        newaddr = shmemi_mem_realloc (addr, size);
+    }
+
     if (newaddr == (void *) NULL) {
         shmemi_trace (SHMEM_LOG_MEMORY,
                       "shrealloc(%ld bytes) failed @ original address %p",
@@ -405,6 +483,11 @@ shmemalign_private (size_t alignment, size_t size)
 
     addr = shmemi_mem_align (alignment, size);
 
+    if ((addr == (void *) NULL) &&
+        shmemi_comms_heap_grow (size + alignment)) {
+        addr = shmemi_mem_align (alignment, size);
+    }
+
     if (addr == (void *) NULL) {
         shmemi_trace (SHMEM_LOG_MEMORY,
                       "shmem_memalign(%ld bytes) couldn't realign to %ld",
@@ -440,6 +523,34 @@ shmem_align (size_t alignment, size_t size)
     return shmemalign_private (alignment, size);
 }
 
+#ifdef HAVE_FEATURE_EXPERIMENTAL
+
+/*
+ * the struct has the same name as the call, which is renamed for
+ * profiling below
+ */
+typedef struct shmemx_heap_stats heap_stats_t;
+
+#ifdef HAVE_FEATURE_PSHMEM
+#pragma weak shmemx_heap_stats = pshmemx_heap_stats
+#define shmemx_heap_stats pshmemx_heap_stats
+#endif /* HAVE_FEATURE_PSHMEM */
+
+/**
+ * report how full my symmetric heap is
+ */
+
+void
+shmemx_heap_stats (heap_stats_t *stats)
+{
+    DEBUG_NAME ("shmemx_heap_stats");
+    INIT_CHECK (debug_name);
+
+    shmemi_mem_stats (stats);
+}
+
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
+
 /**
  * readable error message for error code "e"
  */
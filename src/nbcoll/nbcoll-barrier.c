@@ -0,0 +1,101 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#if defined(HAVE_FEATURE_EXPERIMENTAL)
+
+#include <stdio.h>
+#include <string.h>
+
+#include "state.h"
+#include "trace.h"
+#include "utils.h"
+
+#include "comms/comms.h"
+
+#include "shmem.h"
+#include "shmemx.h"
+
+#include "nbcoll.h"
+
+#ifdef HAVE_FEATURE_PSHMEM
+#include "pshmemx.h"
+#endif /* HAVE_FEATURE_PSHMEM */
+
+#ifdef HAVE_FEATURE_PSHMEM
+#pragma weak shmemx_barrier_all_nb = pshmemx_barrier_all_nb
+#define shmemx_barrier_all_nb pshmemx_barrier_all_nb
+#endif /* HAVE_FEATURE_PSHMEM */
+
+/**
+ * No data moves: everyone reports up to PE 0, which then lets
+ * everyone go.  Puts issued before the call are complete before we
+ * report in.
+ */
+
+void
+shmemx_barrier_all_nb (shmemx_request_handle_t *desc)
+{
+    DEBUG_NAME ("shmemx_barrier_all_nb");
+    shmemi_nbcoll_t *rp;
+
+    INIT_CHECK (debug_name);
+
+    shmem_quiet ();
+
+    rp = shmemi_nbcoll_new (0, 0, 0, GET_STATE (numpes),
+                            shmemi_nbcoll_barrier_all_psync ());
+    rp->sweep_up = 1;
+
+    shmemi_nbcoll_start (rp, desc);
+}
+
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
@@ -0,0 +1,132 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#if defined(HAVE_FEATURE_EXPERIMENTAL)
+
+#include <stdio.h>
+#include <string.h>
+
+#include "state.h"
+#include "trace.h"
+#include "utils.h"
+
+#include "comms/comms.h"
+
+#include "shmem.h"
+#include "shmemx.h"
+
+#include "nbcoll.h"
+
+#ifdef HAVE_FEATURE_PSHMEM
+#include "pshmemx.h"
+#endif /* HAVE_FEATURE_PSHMEM */
+
+/*
+ * The tree is rooted at index 0, so a child's subtree covers a
+ * contiguous run of blocks starting at its own: gather those on the
+ * way up, then copy the whole result down.
+ */
+
+static void
+fcollect_up (shmemi_nbcoll_t *rp, int child_rel, int child_span,
+             int child_pe)
+{
+    char *at = (char *) rp->target + child_rel * rp->nbytes;
+
+    shmem_getmem (at, at, child_span * rp->nbytes, child_pe);
+}
+
+static void
+fcollect_down (shmemi_nbcoll_t *rp, int parent_rel, int parent_pe)
+{
+    shmem_getmem (rp->target, rp->target, rp->PE_size * rp->nbytes,
+                  parent_pe);
+}
+
+#ifdef HAVE_FEATURE_PSHMEM
+#pragma weak shmemx_fcollect32_nb = pshmemx_fcollect32_nb
+#define shmemx_fcollect32_nb pshmemx_fcollect32_nb
+#pragma weak shmemx_fcollect64_nb = pshmemx_fcollect64_nb
+#define shmemx_fcollect64_nb pshmemx_fcollect64_nb
+#endif /* HAVE_FEATURE_PSHMEM */
+
+#define SHMEMX_FCOLLECT_NB(Bits)                                        \
+    void                                                                \
+    shmemx_fcollect##Bits##_nb (void *target, const void *source,       \
+                                size_t nelems,                          \
+                                int PE_start, int logPE_stride,         \
+                                int PE_size, long *pSync,               \
+                                shmemx_request_handle_t *desc)          \
+    {                                                                   \
+        DEBUG_NAME ("shmemx_fcollect" #Bits "_nb");                     \
+        shmemi_nbcoll_t *rp;                                            \
+        INIT_CHECK (debug_name);                                        \
+        SYMMETRY_CHECK (target, 1, debug_name);                         \
+        SYMMETRY_CHECK (source, 2, debug_name);                         \
+        SYMMETRY_CHECK (pSync, 7, debug_name);                          \
+        PE_RANGE_CHECK (PE_start, 4, debug_name);                       \
+        rp = shmemi_nbcoll_new (0, PE_start, logPE_stride,              \
+                                PE_size, pSync);                        \
+        rp->sweep_up = 1;                                               \
+        rp->up = fcollect_up;                                           \
+        rp->down = fcollect_down;                                       \
+        rp->target = target;                                            \
+        rp->nbytes = nelems * (Bits / 8);                               \
+        memcpy ((char *) target + rp->rel * rp->nbytes, source,         \
+                rp->nbytes);                                            \
+        shmemi_nbcoll_start (rp, desc);                                 \
+    }
+
+SHMEMX_FCOLLECT_NB (32);
+SHMEMX_FCOLLECT_NB (64);
+
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
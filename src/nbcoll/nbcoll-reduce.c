@@ -0,0 +1,184 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#if defined(HAVE_FEATURE_EXPERIMENTAL)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "state.h"
+#include "trace.h"
+#include "utils.h"
+
+#include "comms/comms.h"
+
+#include "shmem.h"
+#include "shmemx.h"
+
+#include "nbcoll.h"
+
+#ifdef HAVE_FEATURE_PSHMEM
+#include "pshmemx.h"
+#endif /* HAVE_FEATURE_PSHMEM */
+
+/*
+ * Partial results build up in target on the way up the tree (rooted
+ * at index 0), and the root's target is copied down.  pWrk is not
+ * used: each PE keeps a private buffer for its children's partials.
+ */
+
+static void
+reduce_up (shmemi_nbcoll_t *rp, int child_rel, int child_span,
+           int child_pe)
+{
+    shmem_getmem (rp->scratch, rp->target, rp->nbytes, child_pe);
+    (*rp->combine) (rp->target, rp->scratch, rp->nelems);
+}
+
+static void
+reduce_down (shmemi_nbcoll_t *rp, int parent_rel, int parent_pe)
+{
+    shmem_getmem (rp->target, rp->target, rp->nbytes, parent_pe);
+}
+
+#define NBCOLL_SUM_FUNC(Name, Type)                                     \
+    static void                                                         \
+    sum_##Name##_combine (void *target, const void *source,             \
+                          size_t nelems)                                \
+    {                                                                   \
+        Type *t = (Type *) target;                                      \
+        const Type *s = (const Type *) source;                          \
+        size_t i;                                                       \
+        for (i = 0; i < nelems; i += 1) {                               \
+            t[i] += s[i];                                               \
+        }                                                               \
+    }
+
+NBCOLL_SUM_FUNC (short, short);
+NBCOLL_SUM_FUNC (int, int);
+NBCOLL_SUM_FUNC (long, long);
+NBCOLL_SUM_FUNC (longlong, long long);
+NBCOLL_SUM_FUNC (double, double);
+NBCOLL_SUM_FUNC (float, float);
+NBCOLL_SUM_FUNC (longdouble, long double);
+NBCOLL_SUM_FUNC (complexd, double complex);
+NBCOLL_SUM_FUNC (complexf, float complex);
+
+#ifdef HAVE_FEATURE_PSHMEM
+#pragma weak shmemx_short_sum_to_all_nb = pshmemx_short_sum_to_all_nb
+#define shmemx_short_sum_to_all_nb pshmemx_short_sum_to_all_nb
+#pragma weak shmemx_int_sum_to_all_nb = pshmemx_int_sum_to_all_nb
+#define shmemx_int_sum_to_all_nb pshmemx_int_sum_to_all_nb
+#pragma weak shmemx_long_sum_to_all_nb = pshmemx_long_sum_to_all_nb
+#define shmemx_long_sum_to_all_nb pshmemx_long_sum_to_all_nb
+#pragma weak shmemx_longlong_sum_to_all_nb = pshmemx_longlong_sum_to_all_nb
+#define shmemx_longlong_sum_to_all_nb pshmemx_longlong_sum_to_all_nb
+#pragma weak shmemx_double_sum_to_all_nb = pshmemx_double_sum_to_all_nb
+#define shmemx_double_sum_to_all_nb pshmemx_double_sum_to_all_nb
+#pragma weak shmemx_float_sum_to_all_nb = pshmemx_float_sum_to_all_nb
+#define shmemx_float_sum_to_all_nb pshmemx_float_sum_to_all_nb
+#pragma weak shmemx_longdouble_sum_to_all_nb = pshmemx_longdouble_sum_to_all_nb
+#define shmemx_longdouble_sum_to_all_nb pshmemx_longdouble_sum_to_all_nb
+#pragma weak shmemx_complexd_sum_to_all_nb = pshmemx_complexd_sum_to_all_nb
+#define shmemx_complexd_sum_to_all_nb pshmemx_complexd_sum_to_all_nb
+#pragma weak shmemx_complexf_sum_to_all_nb = pshmemx_complexf_sum_to_all_nb
+#define shmemx_complexf_sum_to_all_nb pshmemx_complexf_sum_to_all_nb
+#endif /* HAVE_FEATURE_PSHMEM */
+
+#define SHMEMX_SUM_TO_ALL_NB(Name, Type)                                \
+    void                                                                \
+    shmemx_##Name##_sum_to_all_nb (Type *target, Type *source,          \
+                                   int nreduce,                         \
+                                   int PE_start, int logPE_stride,      \
+                                   int PE_size,                         \
+                                   Type *pWrk, long *pSync,             \
+                                   shmemx_request_handle_t *desc)       \
+    {                                                                   \
+        DEBUG_NAME ("shmemx_" #Name "_sum_to_all_nb");                  \
+        shmemi_nbcoll_t *rp;                                            \
+        INIT_CHECK (debug_name);                                        \
+        SYMMETRY_CHECK (target, 1, debug_name);                         \
+        SYMMETRY_CHECK (source, 2, debug_name);                         \
+        rp = shmemi_nbcoll_new (0, PE_start, logPE_stride,              \
+                                PE_size, pSync);                        \
+        rp->sweep_up = 1;                                               \
+        rp->up = reduce_up;                                             \
+        rp->down = reduce_down;                                         \
+        rp->combine = sum_##Name##_combine;                             \
+        rp->target = target;                                            \
+        rp->nelems = nreduce;                                           \
+        rp->nbytes = nreduce * sizeof (Type);                           \
+        rp->scratch = malloc (rp->nbytes);                              \
+        if (EXPR_UNLIKELY (rp->scratch == NULL && rp->nbytes > 0)) {    \
+            shmemi_trace (SHMEM_LOG_FATAL,                              \
+                          "internal error: unable to allocate %lu bytes" \
+                          " for non-blocking reduction",                \
+                          (unsigned long) rp->nbytes);                  \
+            return;                                                     \
+            /* NOT REACHED */                                           \
+        }                                                               \
+        memmove (target, source, rp->nbytes);                           \
+        shmemi_nbcoll_start (rp, desc);                                 \
+    }
+
+SHMEMX_SUM_TO_ALL_NB (short, short);
+SHMEMX_SUM_TO_ALL_NB (int, int);
+SHMEMX_SUM_TO_ALL_NB (long, long);
+SHMEMX_SUM_TO_ALL_NB (longlong, long long);
+SHMEMX_SUM_TO_ALL_NB (double, double);
+SHMEMX_SUM_TO_ALL_NB (float, float);
+SHMEMX_SUM_TO_ALL_NB (longdouble, long double);
+SHMEMX_SUM_TO_ALL_NB (complexd, double complex);
+SHMEMX_SUM_TO_ALL_NB (complexf, float complex);
+
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
@@ -0,0 +1,474 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#if defined(HAVE_FEATURE_EXPERIMENTAL)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "state.h"
+#include "trace.h"
+#include "utils.h"
+#include "atomic.h"
+#include "memalloc.h"
+
+#include "comms/comms.h"
+
+#include "shmem.h"
+#include "shmemx.h"
+
+#include "nbcoll.h"
+
+/*
+ * Non-blocking collectives are queued in the order they were started
+ * and run strictly in that order, so every PE sees the same sequence
+ * on a given pSync.  The head of the queue is advanced whenever the
+ * program tests or waits on any collective handle, and from the
+ * progress thread if there is one.
+ *
+ * Data always flows by get: a PE only reads from a neighbour that has
+ * told it the data is ready, and a parent waits for its children to
+ * acknowledge before it is done.  So nobody's target is written
+ * behind its back, and each pSync slot has been cleared by its owner
+ * before anyone can set it again.  The pSync can be reused as soon as
+ * the request completes.
+ */
+
+static shmemi_nbcoll_t *queue_head = NULL;
+static shmemi_nbcoll_t *queue_tail = NULL;
+
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * barrier_all has no pSync of its own
+ */
+static long *barrier_all_psync = NULL;
+
+enum
+{
+    PHASE_UP = 0,
+    PHASE_DOWN,
+    PHASE_ACK
+};
+
+/**
+ * translate index relative to the root into a PE number
+ */
+static inline int
+rel_to_pe (shmemi_nbcoll_t *rp, int rel)
+{
+    const int idx = (rel + rp->root) % rp->PE_size;
+
+    return rp->PE_start + (idx << rp->logPE_stride);
+}
+
+/**
+ * binomial tree on relative indices: the children of "rel" are rel +
+ * 2^k for each 2^k below the lowest bit set in rel (or below PE_size
+ * for the root).  Bit k of the result is set if that child exists.
+ */
+static unsigned int
+children_of (shmemi_nbcoll_t *rp)
+{
+    unsigned int mask = 0;
+    int k;
+
+    for (k = 0; k < NBCOLL_MAX_CHILDREN; k += 1) {
+        const int dist = 1 << k;
+
+        if ((rp->rel & dist) != 0) {
+            break;
+        }
+        if (dist >= rp->PE_size - rp->rel) {
+            break;
+        }
+        mask |= 1U << k;
+    }
+    return mask;
+}
+
+/**
+ * which child of our parent we are (log2 of our lowest bit)
+ */
+static inline int
+child_index (int rel)
+{
+    int k = 0;
+
+    while ((rel & (1 << k)) == 0) {
+        k += 1;
+    }
+    return k;
+}
+
+static inline int
+parent_of (int rel)
+{
+    return rel & (rel - 1);
+}
+
+/**
+ * has this slot been set?  If so, clear it for next time.
+ */
+static inline int
+take_flag (long *slot)
+{
+    if (* (volatile long *) slot == SHMEM_SYNC_VALUE) {
+        return 0;
+    }
+    *slot = SHMEM_SYNC_VALUE;
+    LOAD_STORE_FENCE ();
+    return 1;
+}
+
+static inline void
+set_flag (long *slot, int pe)
+{
+    LOAD_STORE_FENCE ();
+    shmem_long_p (slot, SHMEM_SYNC_VALUE + 1, pe);
+}
+
+/**
+ * move the request on as far as it can go without waiting.  Return
+ * non-zero when it is complete on this PE.
+ */
+static int
+step (shmemi_nbcoll_t *rp)
+{
+    long *ps = rp->pSync;
+    int k;
+
+    switch (rp->phase) {
+    case PHASE_UP:
+        for (k = 0; k < NBCOLL_MAX_CHILDREN; k += 1) {
+            if ((rp->pending & (1U << k)) == 0) {
+                continue;
+            }
+            if (take_flag (&ps[NBCOLL_UP_SLOT (k)])) {
+                const int child = rp->rel + (1 << k);
+
+                if (rp->up != NULL) {
+                    const int left = rp->PE_size - child;
+                    const int span = (left < (1 << k)) ? left : (1 << k);
+
+                    (*rp->up) (rp, child, span, rel_to_pe (rp, child));
+                }
+                rp->pending &= ~(1U << k);
+            }
+        }
+        if (rp->pending != 0) {
+            return 0;
+        }
+        if (rp->rel != 0) {
+            set_flag (&ps[NBCOLL_UP_SLOT (child_index (rp->rel))],
+                      rel_to_pe (rp, parent_of (rp->rel)));
+        }
+        rp->phase = PHASE_DOWN;
+        /* fall through */
+
+    case PHASE_DOWN:
+        if (rp->rel != 0) {
+            const int parent = parent_of (rp->rel);
+            const int parent_pe = rel_to_pe (rp, parent);
+
+            if (!take_flag (&ps[NBCOLL_DOWN_SLOT])) {
+                return 0;
+            }
+            if (rp->down != NULL) {
+                (*rp->down) (rp, parent, parent_pe);
+            }
+            set_flag (&ps[NBCOLL_ACK_SLOT (child_index (rp->rel))],
+                      parent_pe);
+        }
+        rp->pending = children_of (rp);
+        for (k = 0; k < NBCOLL_MAX_CHILDREN; k += 1) {
+            if ((rp->pending & (1U << k)) != 0) {
+                set_flag (&ps[NBCOLL_DOWN_SLOT],
+                          rel_to_pe (rp, rp->rel + (1 << k)));
+            }
+        }
+        rp->phase = PHASE_ACK;
+        /* fall through */
+
+    case PHASE_ACK:
+        for (k = 0; k < NBCOLL_MAX_CHILDREN; k += 1) {
+            if ((rp->pending & (1U << k)) != 0 &&
+                take_flag (&ps[NBCOLL_ACK_SLOT (k)])) {
+                rp->pending &= ~(1U << k);
+            }
+        }
+        return (rp->pending == 0);
+
+    default:
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "internal error: non-blocking collective"
+                      " in unknown phase %d",
+                      rp->phase);
+        return 0;
+        /* NOT REACHED */
+    }
+}
+
+/**
+ * run the queue in order until something has to wait.  Caller holds
+ * the lock.
+ */
+static void
+advance (void)
+{
+    shmemi_nbcoll_t *rp;
+
+    for (rp = queue_head; rp != NULL; rp = rp->next) {
+        if (rp->done) {
+            continue;
+        }
+        if (!step (rp)) {
+            break;
+        }
+        rp->done = 1;
+    }
+}
+
+/**
+ * take a completed request off the queue.  Caller holds the lock.
+ */
+static void
+retire (shmemi_nbcoll_t *rp)
+{
+    shmemi_nbcoll_t *prev = NULL;
+    shmemi_nbcoll_t *cur;
+
+    for (cur = queue_head; cur != rp; cur = cur->next) {
+        prev = cur;
+    }
+    if (prev == NULL) {
+        queue_head = rp->next;
+    }
+    else {
+        prev->next = rp->next;
+    }
+    if (queue_tail == rp) {
+        queue_tail = prev;
+    }
+
+    LOAD_STORE_FENCE ();
+
+    free (rp->scratch);
+    free (rp);
+}
+
+/**
+ * called during initialization of shmem
+ */
+void
+shmemi_nbcoll_init (void)
+{
+    const size_t n = SHMEM_BARRIER_SYNC_SIZE * sizeof (*barrier_all_psync);
+    int i;
+
+    barrier_all_psync = (long *) shmemi_mem_alloc (n);
+    if (EXPR_UNLIKELY (barrier_all_psync == (long *) NULL)) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "internal error: unable to allocate %lu bytes"
+                      " of symmetric memory for non-blocking barrier",
+                      (unsigned long) n);
+        return;
+        /* NOT REACHED */
+    }
+    for (i = 0; i < SHMEM_BARRIER_SYNC_SIZE; i += 1) {
+        barrier_all_psync[i] = SHMEM_SYNC_VALUE;
+    }
+
+    /* no-one may write to my pSync before it is initialized */
+    shmem_barrier_all ();
+}
+
+long *
+shmemi_nbcoll_barrier_all_psync (void)
+{
+    return barrier_all_psync;
+}
+
+/**
+ * a request for this PE in the given active set, with the tree
+ * rooted at index PE_root of the set
+ */
+shmemi_nbcoll_t *
+shmemi_nbcoll_new (int PE_root, int PE_start, int logPE_stride,
+                   int PE_size, long *pSync)
+{
+    const int me = (GET_STATE (mype) - PE_start) >> logPE_stride;
+    shmemi_nbcoll_t *rp = (shmemi_nbcoll_t *) calloc (1, sizeof (*rp));
+
+    if (EXPR_UNLIKELY (rp == (shmemi_nbcoll_t *) NULL)) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "internal error: unable to allocate"
+                      " non-blocking collective request");
+        return NULL;
+        /* NOT REACHED */
+    }
+
+    rp->PE_start = PE_start;
+    rp->logPE_stride = logPE_stride;
+    rp->PE_size = PE_size;
+    rp->root = PE_root;
+    rp->rel = (me - PE_root + PE_size) % PE_size;
+    rp->pSync = pSync;
+
+    return rp;
+}
+
+/**
+ * queue the request, get it going, and hand it back to the caller.
+ * The op-specific fields must be filled in by now.
+ */
+void
+shmemi_nbcoll_start (shmemi_nbcoll_t *rp, shmemx_request_handle_t *desc)
+{
+    if (rp->sweep_up) {
+        rp->pending = children_of (rp);
+        rp->phase = PHASE_UP;
+    }
+    else {
+        rp->phase = PHASE_DOWN;
+    }
+
+    pthread_mutex_lock (&queue_lock);
+
+    if (queue_tail == NULL) {
+        queue_head = rp;
+    }
+    else {
+        queue_tail->next = rp;
+    }
+    queue_tail = rp;
+
+    advance ();
+
+    pthread_mutex_unlock (&queue_lock);
+
+    *desc = (shmemx_request_handle_t) rp;
+}
+
+/**
+ * for the progress thread: don't hold it up if the program is
+ * already in here
+ */
+void
+shmemi_nbcoll_poll (void)
+{
+    if (queue_head == NULL) {
+        return;
+    }
+    if (pthread_mutex_trylock (&queue_lock) == 0) {
+        advance ();
+        pthread_mutex_unlock (&queue_lock);
+    }
+}
+
+/**
+ * is this handle an outstanding collective (rather than a put/get)?
+ */
+int
+shmemi_nbcoll_owns (shmemx_request_handle_t desc)
+{
+    shmemi_nbcoll_t *rp;
+
+    /* nothing queued, so put/get handles cost nothing extra */
+    if ((desc == NULL) || (queue_head == NULL)) {
+        return 0;
+    }
+
+    pthread_mutex_lock (&queue_lock);
+    for (rp = queue_head; rp != NULL; rp = rp->next) {
+        if (rp == (shmemi_nbcoll_t *) desc) {
+            break;
+        }
+    }
+    pthread_mutex_unlock (&queue_lock);
+
+    return (rp != NULL);
+}
+
+void
+shmemi_nbcoll_test (shmemx_request_handle_t desc, int *flag)
+{
+    shmemi_nbcoll_t *rp = (shmemi_nbcoll_t *) desc;
+
+    pthread_mutex_lock (&queue_lock);
+
+    advance ();
+
+    *flag = rp->done;
+    if (rp->done) {
+        retire (rp);
+    }
+
+    pthread_mutex_unlock (&queue_lock);
+}
+
+void
+shmemi_nbcoll_wait (shmemx_request_handle_t desc)
+{
+    int flag;
+
+    for (;;) {
+        shmemi_nbcoll_test (desc, &flag);
+        if (flag) {
+            break;
+        }
+        shmemi_comms_poll ();
+    }
+}
+
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
@@ -0,0 +1,135 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef _NBCOLL_H
+#define _NBCOLL_H 1
+
+#include <sys/types.h>
+
+#include "shmemx.h"
+
+/*
+ * a binomial tree node has at most one child per bit of the PE count
+ */
+#define NBCOLL_MAX_CHILDREN  ((int) (8 * sizeof (int)) - 1)
+
+/*
+ * pSync layout: one "down" slot written by our parent, and one
+ * "up" and one "ack" slot per child
+ */
+#define NBCOLL_DOWN_SLOT  0
+#define NBCOLL_UP_SLOT(k)  (1 + (k))
+#define NBCOLL_ACK_SLOT(k)  (1 + NBCOLL_MAX_CHILDREN + (k))
+
+typedef struct shmemi_nbcoll shmemi_nbcoll_t;
+
+/*
+ * what to do with data when a child reports in on the way up, and
+ * when our parent has the result on the way down
+ */
+typedef void (*shmemi_nbcoll_up_fn) (shmemi_nbcoll_t *rp,
+                                     int child_rel, int child_span,
+                                     int child_pe);
+typedef void (*shmemi_nbcoll_down_fn) (shmemi_nbcoll_t *rp,
+                                       int parent_rel, int parent_pe);
+
+typedef void (*shmemi_nbcoll_combine_fn) (void *target, const void *source,
+                                          size_t nelems);
+
+/**
+ * an outstanding collective, run as a binomial tree over the active
+ * set rooted at "root".  Each step only looks at flags and moves
+ * data that is already there, so it never blocks on another PE.
+ */
+struct shmemi_nbcoll
+{
+    int PE_start;               /* active set */
+    int logPE_stride;
+    int PE_size;
+    int root;                   /* index of tree root in active set */
+    int rel;                    /* my index relative to root */
+    long *pSync;
+
+    int phase;                  /* where we are in the state machine */
+    unsigned int pending;       /* children we're still waiting on */
+    int done;
+
+    int sweep_up;               /* children report in before we go down */
+    shmemi_nbcoll_up_fn up;     /* NULL if no data goes up */
+    shmemi_nbcoll_down_fn down; /* NULL if no data comes down */
+
+    void *target;               /* op-specific */
+    const void *source;
+    size_t nbytes;              /* per-PE data, or reduction size */
+    size_t nelems;
+    shmemi_nbcoll_combine_fn combine;
+    void *scratch;
+
+    shmemi_nbcoll_t *next;
+};
+
+extern void shmemi_nbcoll_init (void);
+
+extern long *shmemi_nbcoll_barrier_all_psync (void);
+
+extern shmemi_nbcoll_t *shmemi_nbcoll_new (int PE_root, int PE_start,
+                                           int logPE_stride, int PE_size,
+                                           long *pSync);
+extern void shmemi_nbcoll_start (shmemi_nbcoll_t *rp,
+                                 shmemx_request_handle_t *desc);
+
+extern void shmemi_nbcoll_poll (void);
+extern int shmemi_nbcoll_owns (shmemx_request_handle_t desc);
+extern void shmemi_nbcoll_wait (shmemx_request_handle_t desc);
+extern void shmemi_nbcoll_test (shmemx_request_handle_t desc, int *flag);
+
+#endif /* _NBCOLL_H */
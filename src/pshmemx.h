@@ -143,6 +143,14 @@ extern "C"
 #define pshmemx_malloc_nb(s)   pshmalloc_nb(s)
 #define pshmemx_free_nb(a)     pshfree_nb(a)
 
+    shmemx_arena_t pshmemx_arena_create (size_t size);
+    void *pshmemx_arena_alloc (shmemx_arena_t arena, size_t size,
+                               size_t align);
+    void pshmemx_arena_reset (shmemx_arena_t arena);
+    void pshmemx_arena_destroy (shmemx_arena_t arena);
+
+    void pshmemx_heap_stats (struct shmemx_heap_stats *stats);
+
     /*
      * Proposed by IBM Zurich
      *
@@ -170,6 +178,496 @@ extern "C"
     int pshmemx_fence_test (void);
     int pshmemx_quiet_test (void);
 
+    /*
+     * teams
+     *
+     */
+    int pshmemx_team_my_pe (shmemx_team_t team);
+    int pshmemx_team_n_pes (shmemx_team_t team);
+    int pshmemx_team_translate_pe (shmemx_team_t src_team, int src_pe,
+                                   shmemx_team_t dest_team);
+
+    int pshmemx_team_split_strided (shmemx_team_t parent,
+                                    int start, int stride, int size,
+                                    shmemx_team_t *newteam);
+    int pshmemx_team_split_2d (shmemx_team_t parent, int xrange,
+                               shmemx_team_t *xaxis, shmemx_team_t *yaxis);
+    void pshmemx_team_destroy (shmemx_team_t team);
+
+    void pshmemx_team_barrier (shmemx_team_t team);
+    void pshmemx_team_broadcast32 (shmemx_team_t team,
+                                   void *target, const void *source,
+                                   size_t nelems, int PE_root);
+    void pshmemx_team_broadcast64 (shmemx_team_t team,
+                                   void *target, const void *source,
+                                   size_t nelems, int PE_root);
+    void pshmemx_team_fcollect32 (shmemx_team_t team,
+                                  void *target, const void *source,
+                                  size_t nelems);
+    void pshmemx_team_fcollect64 (shmemx_team_t team,
+                                  void *target, const void *source,
+                                  size_t nelems);
+    void pshmemx_team_alltoall32 (shmemx_team_t team,
+                                  void *target, const void *source,
+                                  size_t nelems);
+    void pshmemx_team_alltoall64 (shmemx_team_t team,
+                                  void *target, const void *source,
+                                  size_t nelems);
+
+    void pshmemx_team_int_sum_reduce (shmemx_team_t team,
+                                      int *target, const int *source,
+                                      int nreduce);
+    void pshmemx_team_long_sum_reduce (shmemx_team_t team,
+                                       long *target, const long *source,
+                                       int nreduce);
+    void pshmemx_team_longlong_sum_reduce (shmemx_team_t team,
+                                           long long *target, const long long *source,
+                                           int nreduce);
+    void pshmemx_team_float_sum_reduce (shmemx_team_t team,
+                                        float *target, const float *source,
+                                        int nreduce);
+    void pshmemx_team_double_sum_reduce (shmemx_team_t team,
+                                         double *target, const double *source,
+                                         int nreduce);
+    void pshmemx_team_int_prod_reduce (shmemx_team_t team,
+                                       int *target, const int *source,
+                                       int nreduce);
+    void pshmemx_team_long_prod_reduce (shmemx_team_t team,
+                                        long *target, const long *source,
+                                        int nreduce);
+    void pshmemx_team_longlong_prod_reduce (shmemx_team_t team,
+                                            long long *target, const long long *source,
+                                            int nreduce);
+    void pshmemx_team_float_prod_reduce (shmemx_team_t team,
+                                         float *target, const float *source,
+                                         int nreduce);
+    void pshmemx_team_double_prod_reduce (shmemx_team_t team,
+                                          double *target, const double *source,
+                                          int nreduce);
+    void pshmemx_team_int_min_reduce (shmemx_team_t team,
+                                      int *target, const int *source,
+                                      int nreduce);
+    void pshmemx_team_long_min_reduce (shmemx_team_t team,
+                                       long *target, const long *source,
+                                       int nreduce);
+    void pshmemx_team_longlong_min_reduce (shmemx_team_t team,
+                                           long long *target, const long long *source,
+                                           int nreduce);
+    void pshmemx_team_float_min_reduce (shmemx_team_t team,
+                                        float *target, const float *source,
+                                        int nreduce);
+    void pshmemx_team_double_min_reduce (shmemx_team_t team,
+                                         double *target, const double *source,
+                                         int nreduce);
+    void pshmemx_team_int_max_reduce (shmemx_team_t team,
+                                      int *target, const int *source,
+                                      int nreduce);
+    void pshmemx_team_long_max_reduce (shmemx_team_t team,
+                                       long *target, const long *source,
+                                       int nreduce);
+    void pshmemx_team_longlong_max_reduce (shmemx_team_t team,
+                                           long long *target, const long long *source,
+                                           int nreduce);
+    void pshmemx_team_float_max_reduce (shmemx_team_t team,
+                                        float *target, const float *source,
+                                        int nreduce);
+    void pshmemx_team_double_max_reduce (shmemx_team_t team,
+                                         double *target, const double *source,
+                                         int nreduce);
+    void pshmemx_team_int_and_reduce (shmemx_team_t team,
+                                      int *target, const int *source,
+                                      int nreduce);
+    void pshmemx_team_long_and_reduce (shmemx_team_t team,
+                                       long *target, const long *source,
+                                       int nreduce);
+    void pshmemx_team_longlong_and_reduce (shmemx_team_t team,
+                                           long long *target, const long long *source,
+                                           int nreduce);
+    void pshmemx_team_int_or_reduce (shmemx_team_t team,
+                                     int *target, const int *source,
+                                     int nreduce);
+    void pshmemx_team_long_or_reduce (shmemx_team_t team,
+                                      long *target, const long *source,
+                                      int nreduce);
+    void pshmemx_team_longlong_or_reduce (shmemx_team_t team,
+                                          long long *target, const long long *source,
+                                          int nreduce);
+    void pshmemx_team_int_xor_reduce (shmemx_team_t team,
+                                      int *target, const int *source,
+                                      int nreduce);
+    void pshmemx_team_long_xor_reduce (shmemx_team_t team,
+                                       long *target, const long *source,
+                                       int nreduce);
+    void pshmemx_team_longlong_xor_reduce (shmemx_team_t team,
+                                           long long *target, const long long *source,
+                                           int nreduce);
+
+    /*
+     * non-blocking collectives
+     *
+     */
+    void pshmemx_barrier_all_nb (shmemx_request_handle_t *desc);
+    void pshmemx_broadcast32_nb (void *target, const void *source,
+                                 size_t nelems, int PE_root, int PE_start,
+                                 int logPE_stride, int PE_size, long *pSync,
+                                 shmemx_request_handle_t *desc);
+    void pshmemx_broadcast64_nb (void *target, const void *source,
+                                 size_t nelems, int PE_root, int PE_start,
+                                 int logPE_stride, int PE_size, long *pSync,
+                                 shmemx_request_handle_t *desc);
+    void pshmemx_fcollect32_nb (void *target, const void *source,
+                                size_t nelems, int PE_start,
+                                int logPE_stride, int PE_size, long *pSync,
+                                shmemx_request_handle_t *desc);
+    void pshmemx_fcollect64_nb (void *target, const void *source,
+                                size_t nelems, int PE_start,
+                                int logPE_stride, int PE_size, long *pSync,
+                                shmemx_request_handle_t *desc);
+    void pshmemx_short_sum_to_all_nb (short *target,
+                                      short *source, int nreduce,
+                                      int PE_start, int logPE_stride,
+                                      int PE_size, short *pWrk,
+                                      long *pSync,
+                                      shmemx_request_handle_t *desc);
+    void pshmemx_int_sum_to_all_nb (int *target,
+                                    int *source, int nreduce,
+                                    int PE_start, int logPE_stride,
+                                    int PE_size, int *pWrk,
+                                    long *pSync,
+                                    shmemx_request_handle_t *desc);
+    void pshmemx_long_sum_to_all_nb (long *target,
+                                     long *source, int nreduce,
+                                     int PE_start, int logPE_stride,
+                                     int PE_size, long *pWrk,
+                                     long *pSync,
+                                     shmemx_request_handle_t *desc);
+    void pshmemx_longlong_sum_to_all_nb (long long *target,
+                                         long long *source, int nreduce,
+                                         int PE_start, int logPE_stride,
+                                         int PE_size, long long *pWrk,
+                                         long *pSync,
+                                         shmemx_request_handle_t *desc);
+    void pshmemx_double_sum_to_all_nb (double *target,
+                                       double *source, int nreduce,
+                                       int PE_start, int logPE_stride,
+                                       int PE_size, double *pWrk,
+                                       long *pSync,
+                                       shmemx_request_handle_t *desc);
+    void pshmemx_float_sum_to_all_nb (float *target,
+                                      float *source, int nreduce,
+                                      int PE_start, int logPE_stride,
+                                      int PE_size, float *pWrk,
+                                      long *pSync,
+                                      shmemx_request_handle_t *desc);
+    void pshmemx_longdouble_sum_to_all_nb (long double *target,
+                                           long double *source, int nreduce,
+                                           int PE_start, int logPE_stride,
+                                           int PE_size, long double *pWrk,
+                                           long *pSync,
+                                           shmemx_request_handle_t *desc);
+    void pshmemx_complexd_sum_to_all_nb (COMPLEXIFY (double) * target,
+                                         COMPLEXIFY (double) * source, int nreduce,
+                                         int PE_start, int logPE_stride,
+                                         int PE_size, COMPLEXIFY (double) * pWrk,
+                                         long *pSync,
+                                         shmemx_request_handle_t *desc);
+    void pshmemx_complexf_sum_to_all_nb (COMPLEXIFY (float) * target,
+                                         COMPLEXIFY (float) * source, int nreduce,
+                                         int PE_start, int logPE_stride,
+                                         int PE_size, COMPLEXIFY (float) * pWrk,
+                                         long *pSync,
+                                         shmemx_request_handle_t *desc);
+
+    /*
+     * scans
+     */
+    void pshmemx_int_sum_inscan (int *target, int *source,
+                                 int nreduce, int PE_start,
+                                 int logPE_stride, int PE_size,
+                                 int *pWrk, long *pSync);
+    void pshmemx_int_sum_exscan (int *target, int *source,
+                                 int nreduce, int PE_start,
+                                 int logPE_stride, int PE_size,
+                                 int *pWrk, long *pSync);
+    void pshmemx_long_sum_inscan (long *target, long *source,
+                                  int nreduce, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  long *pWrk, long *pSync);
+    void pshmemx_long_sum_exscan (long *target, long *source,
+                                  int nreduce, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  long *pWrk, long *pSync);
+    void pshmemx_longlong_sum_inscan (long long *target, long long *source,
+                                      int nreduce, int PE_start,
+                                      int logPE_stride, int PE_size,
+                                      long long *pWrk, long *pSync);
+    void pshmemx_longlong_sum_exscan (long long *target, long long *source,
+                                      int nreduce, int PE_start,
+                                      int logPE_stride, int PE_size,
+                                      long long *pWrk, long *pSync);
+    void pshmemx_float_sum_inscan (float *target, float *source,
+                                   int nreduce, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   float *pWrk, long *pSync);
+    void pshmemx_float_sum_exscan (float *target, float *source,
+                                   int nreduce, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   float *pWrk, long *pSync);
+    void pshmemx_double_sum_inscan (double *target, double *source,
+                                    int nreduce, int PE_start,
+                                    int logPE_stride, int PE_size,
+                                    double *pWrk, long *pSync);
+    void pshmemx_double_sum_exscan (double *target, double *source,
+                                    int nreduce, int PE_start,
+                                    int logPE_stride, int PE_size,
+                                    double *pWrk, long *pSync);
+    void pshmemx_int_max_inscan (int *target, int *source,
+                                 int nreduce, int PE_start,
+                                 int logPE_stride, int PE_size,
+                                 int *pWrk, long *pSync);
+    void pshmemx_int_max_exscan (int *target, int *source,
+                                 int nreduce, int PE_start,
+                                 int logPE_stride, int PE_size,
+                                 int *pWrk, long *pSync);
+    void pshmemx_long_max_inscan (long *target, long *source,
+                                  int nreduce, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  long *pWrk, long *pSync);
+    void pshmemx_long_max_exscan (long *target, long *source,
+                                  int nreduce, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  long *pWrk, long *pSync);
+    void pshmemx_longlong_max_inscan (long long *target, long long *source,
+                                      int nreduce, int PE_start,
+                                      int logPE_stride, int PE_size,
+                                      long long *pWrk, long *pSync);
+    void pshmemx_longlong_max_exscan (long long *target, long long *source,
+                                      int nreduce, int PE_start,
+                                      int logPE_stride, int PE_size,
+                                      long long *pWrk, long *pSync);
+    void pshmemx_float_max_inscan (float *target, float *source,
+                                   int nreduce, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   float *pWrk, long *pSync);
+    void pshmemx_float_max_exscan (float *target, float *source,
+                                   int nreduce, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   float *pWrk, long *pSync);
+    void pshmemx_double_max_inscan (double *target, double *source,
+                                    int nreduce, int PE_start,
+                                    int logPE_stride, int PE_size,
+                                    double *pWrk, long *pSync);
+    void pshmemx_double_max_exscan (double *target, double *source,
+                                    int nreduce, int PE_start,
+                                    int logPE_stride, int PE_size,
+                                    double *pWrk, long *pSync);
+    void pshmemx_int_min_inscan (int *target, int *source,
+                                 int nreduce, int PE_start,
+                                 int logPE_stride, int PE_size,
+                                 int *pWrk, long *pSync);
+    void pshmemx_int_min_exscan (int *target, int *source,
+                                 int nreduce, int PE_start,
+                                 int logPE_stride, int PE_size,
+                                 int *pWrk, long *pSync);
+    void pshmemx_long_min_inscan (long *target, long *source,
+                                  int nreduce, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  long *pWrk, long *pSync);
+    void pshmemx_long_min_exscan (long *target, long *source,
+                                  int nreduce, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  long *pWrk, long *pSync);
+    void pshmemx_longlong_min_inscan (long long *target, long long *source,
+                                      int nreduce, int PE_start,
+                                      int logPE_stride, int PE_size,
+                                      long long *pWrk, long *pSync);
+    void pshmemx_longlong_min_exscan (long long *target, long long *source,
+                                      int nreduce, int PE_start,
+                                      int logPE_stride, int PE_size,
+                                      long long *pWrk, long *pSync);
+    void pshmemx_float_min_inscan (float *target, float *source,
+                                   int nreduce, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   float *pWrk, long *pSync);
+    void pshmemx_float_min_exscan (float *target, float *source,
+                                   int nreduce, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   float *pWrk, long *pSync);
+    void pshmemx_double_min_inscan (double *target, double *source,
+                                    int nreduce, int PE_start,
+                                    int logPE_stride, int PE_size,
+                                    double *pWrk, long *pSync);
+    void pshmemx_double_min_exscan (double *target, double *source,
+                                    int nreduce, int PE_start,
+                                    int logPE_stride, int PE_size,
+                                    double *pWrk, long *pSync);
+    void pshmemx_int_prod_inscan (int *target, int *source,
+                                  int nreduce, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  int *pWrk, long *pSync);
+    void pshmemx_int_prod_exscan (int *target, int *source,
+                                  int nreduce, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  int *pWrk, long *pSync);
+    void pshmemx_long_prod_inscan (long *target, long *source,
+                                   int nreduce, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   long *pWrk, long *pSync);
+    void pshmemx_long_prod_exscan (long *target, long *source,
+                                   int nreduce, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   long *pWrk, long *pSync);
+    void pshmemx_longlong_prod_inscan (long long *target, long long *source,
+                                       int nreduce, int PE_start,
+                                       int logPE_stride, int PE_size,
+                                       long long *pWrk, long *pSync);
+    void pshmemx_longlong_prod_exscan (long long *target, long long *source,
+                                       int nreduce, int PE_start,
+                                       int logPE_stride, int PE_size,
+                                       long long *pWrk, long *pSync);
+    void pshmemx_float_prod_inscan (float *target, float *source,
+                                    int nreduce, int PE_start,
+                                    int logPE_stride, int PE_size,
+                                    float *pWrk, long *pSync);
+    void pshmemx_float_prod_exscan (float *target, float *source,
+                                    int nreduce, int PE_start,
+                                    int logPE_stride, int PE_size,
+                                    float *pWrk, long *pSync);
+    void pshmemx_double_prod_inscan (double *target, double *source,
+                                     int nreduce, int PE_start,
+                                     int logPE_stride, int PE_size,
+                                     double *pWrk, long *pSync);
+    void pshmemx_double_prod_exscan (double *target, double *source,
+                                     int nreduce, int PE_start,
+                                     int logPE_stride, int PE_size,
+                                     double *pWrk, long *pSync);
+
+    /*
+     * rooted reductions
+     */
+    void pshmemx_short_sum_to_root (short *target,
+                                    short *source, int nreduce,
+                                    int PE_root, int PE_start,
+                                    int logPE_stride, int PE_size,
+                                    short *pWrk, long *pSync);
+    void pshmemx_int_sum_to_root (int *target,
+                                  int *source, int nreduce,
+                                  int PE_root, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  int *pWrk, long *pSync);
+    void pshmemx_long_sum_to_root (long *target,
+                                   long *source, int nreduce,
+                                   int PE_root, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   long *pWrk, long *pSync);
+    void pshmemx_longlong_sum_to_root (long long *target,
+                                       long long *source, int nreduce,
+                                       int PE_root, int PE_start,
+                                       int logPE_stride, int PE_size,
+                                       long long *pWrk, long *pSync);
+    void pshmemx_double_sum_to_root (double *target,
+                                     double *source, int nreduce,
+                                     int PE_root, int PE_start,
+                                     int logPE_stride, int PE_size,
+                                     double *pWrk, long *pSync);
+    void pshmemx_float_sum_to_root (float *target,
+                                    float *source, int nreduce,
+                                    int PE_root, int PE_start,
+                                    int logPE_stride, int PE_size,
+                                    float *pWrk, long *pSync);
+    void pshmemx_longdouble_sum_to_root (long double *target,
+                                         long double *source, int nreduce,
+                                         int PE_root, int PE_start,
+                                         int logPE_stride, int PE_size,
+                                         long double *pWrk, long *pSync);
+    void pshmemx_complexd_sum_to_root (COMPLEXIFY (double) * target,
+                                       COMPLEXIFY (double) * source, int nreduce,
+                                       int PE_root, int PE_start,
+                                       int logPE_stride, int PE_size,
+                                       COMPLEXIFY (double) * pWrk, long *pSync);
+    void pshmemx_complexf_sum_to_root (COMPLEXIFY (float) * target,
+                                       COMPLEXIFY (float) * source, int nreduce,
+                                       int PE_root, int PE_start,
+                                       int logPE_stride, int PE_size,
+                                       COMPLEXIFY (float) * pWrk, long *pSync);
+    void pshmemx_short_sum_reduce_scatter (short *target,
+                                           short *source, int nreduce,
+                                           int PE_start, int logPE_stride,
+                                           int PE_size, short *pWrk,
+                                           long *pSync);
+    void pshmemx_int_sum_reduce_scatter (int *target,
+                                         int *source, int nreduce,
+                                         int PE_start, int logPE_stride,
+                                         int PE_size, int *pWrk,
+                                         long *pSync);
+    void pshmemx_long_sum_reduce_scatter (long *target,
+                                          long *source, int nreduce,
+                                          int PE_start, int logPE_stride,
+                                          int PE_size, long *pWrk,
+                                          long *pSync);
+    void pshmemx_longlong_sum_reduce_scatter (long long *target,
+                                              long long *source, int nreduce,
+                                              int PE_start, int logPE_stride,
+                                              int PE_size, long long *pWrk,
+                                              long *pSync);
+    void pshmemx_double_sum_reduce_scatter (double *target,
+                                            double *source, int nreduce,
+                                            int PE_start, int logPE_stride,
+                                            int PE_size, double *pWrk,
+                                            long *pSync);
+    void pshmemx_float_sum_reduce_scatter (float *target,
+                                           float *source, int nreduce,
+                                           int PE_start, int logPE_stride,
+                                           int PE_size, float *pWrk,
+                                           long *pSync);
+    void pshmemx_longdouble_sum_reduce_scatter (long double *target,
+                                                long double *source, int nreduce,
+                                                int PE_start, int logPE_stride,
+                                                int PE_size, long double *pWrk,
+                                                long *pSync);
+    void pshmemx_complexd_sum_reduce_scatter (COMPLEXIFY (double) * target,
+                                              COMPLEXIFY (double) * source, int nreduce,
+                                              int PE_start, int logPE_stride,
+                                              int PE_size, COMPLEXIFY (double) * pWrk,
+                                              long *pSync);
+    void pshmemx_complexf_sum_reduce_scatter (COMPLEXIFY (float) * target,
+                                              COMPLEXIFY (float) * source, int nreduce,
+                                              int PE_start, int logPE_stride,
+                                              int PE_size, COMPLEXIFY (float) * pWrk,
+                                              long *pSync);
+
+    /*
+     * user-defined reductions
+     */
+    void pshmemx_reduce_udr (void *target, const void *source,
+                             size_t nreduce, size_t elem_size,
+                             void (*op) (void *inout, const void *in,
+                                         size_t n),
+                             int PE_start, int logPE_stride, int PE_size,
+                             void *pWrk, long *pSync);
+
+    /*
+     * untyped and variable-count collectives
+     */
+    void pshmemx_broadcastmem (void *target, const void *source,
+                               size_t nbytes, int PE_root, int PE_start,
+                               int logPE_stride, int PE_size, long *pSync);
+    void pshmemx_fcollectmem (void *target, const void *source,
+                              size_t nbytes, int PE_start,
+                              int logPE_stride, int PE_size, long *pSync);
+    void pshmemx_alltoallv (void *target, size_t *target_counts,
+                            size_t *target_displs,
+                            const void *source,
+                            const size_t *source_counts,
+                            const size_t *source_displs,
+                            int PE_start, int logPE_stride, int PE_size,
+                            long *pSync);
+
+    /*
+     * collective tuning
+     */
+    void pshmemx_collective_tune (const char *path);
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
@@ -59,6 +59,7 @@
 #include "shmem.h"
 
 #include "comms/comms.h"
+#include "nbcoll.h"
 
 #ifdef HAVE_FEATURE_PSHMEM
 #include "pshmem.h"
@@ -290,22 +291,30 @@ shmemx_get_nb (long *target, const long *source, size_t nelems,
 #endif /* HAVE_FEATURE_PSHMEM */
 
 /**
- * Wait for handle to be completed
+ * Wait for handle (put/get or collective) to be completed
  */
 
 void
 shmemx_wait_req (shmemx_request_handle_t desc)
 {
+    if (shmemi_nbcoll_owns (desc)) {
+        shmemi_nbcoll_wait (desc);
+        return;
+    }
     shmemi_comms_wait_req (desc);
 }
 
 /**
- * Test whether handle has been completed
+ * Test whether handle (put/get or collective) has been completed
  */
 
 void
 shmemx_test_req (shmemx_request_handle_t desc, int *flag)
 {
+    if (shmemi_nbcoll_owns (desc)) {
+        shmemi_nbcoll_test (desc, flag);
+        return;
+    }
     shmemi_comms_test_req (desc, flag);
 }
 
@@ -53,6 +53,8 @@
 #include "trace.h"
 #include "utils.h"
 
+#include "comms.h"
+
 #include "shmem.h"
 
 #ifdef HAVE_FEATURE_PSHMEM
@@ -113,15 +115,11 @@ extern void shmem_char_iget (char *target, const char *source, ptrdiff_t tst,
                          ptrdiff_t tst, ptrdiff_t sst, size_t nelems, int pe) \
     {                                                                   \
         DEBUG_NAME ("shmem_" #Name "_iput");                            \
-        size_t ti = 0, si = 0;                                          \
-        size_t i;                                                       \
         INIT_CHECK (debug_name);                                        \
         PE_RANGE_CHECK (pe, 6, debug_name);                             \
-        for (i = 0; i < nelems; i += 1) {                               \
-            shmem_##Name##_p (& (target[ti]), source[si], pe);          \
-            ti += tst;                                                  \
-            si += sst;                                                  \
-        }                                                               \
+        SYMMETRY_CHECK (target, 1, debug_name);                         \
+        shmemi_comms_iput (target, (Type *) source, tst, sst,           \
+                           nelems, sizeof (Type), pe);                  \
     }
 
 SHMEM_EMIT_IPUT (char, char);
@@ -195,15 +193,11 @@ shmem_iput128 (void *target, const void *source,
                          ptrdiff_t tst, ptrdiff_t sst, size_t nelems, int pe) \
     {                                                                   \
         DEBUG_NAME ("shmem_" #Name "_iget");                            \
-        size_t ti = 0, si = 0;                                          \
-        size_t i;                                                       \
         INIT_CHECK (debug_name);                                        \
         PE_RANGE_CHECK (pe, 6, debug_name);                             \
-        for (i = 0; i < nelems; i += 1) {                               \
-            target[ti] = shmem_##Name##_g ((Type *) & (source[si]), pe); \
-            ti += tst;                                                  \
-            si += sst;                                                  \
-        }                                                               \
+        SYMMETRY_CHECK (source, 2, debug_name);                         \
+        shmemi_comms_iget (target, (Type *) source, tst, sst,           \
+                           nelems, sizeof (Type), pe);                  \
     }
 
 SHMEM_EMIT_IGET (char, char);
@@ -50,12 +50,17 @@
  */
 
 
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+
 #include "state.h"
 #include "trace.h"
 #include "putget.h"
 #include "globalvar.h"
 #include "utils.h"
 #include "atomic.h"
+#include "locality.h"
 
 #include "comms/comms.h"
 
@@ -65,6 +70,54 @@
 #include "pshmem.h"
 #endif /* HAVE_FEATURE_PSHMEM */
 
+#ifdef HAVE_FEATURE_EXPERIMENTAL
+#include "shmemx.h"
+#ifdef HAVE_FEATURE_PSHMEM
+#include "pshmemx.h"
+#endif /* HAVE_FEATURE_PSHMEM */
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
+
+#include "reduce.h"
+
+static char *default_implementation = "linear";
+
+static int use_hierarchical = 0;
+
+/*
+ * called during initialization of shmem
+ *
+ */
+
+void
+shmemi_reduce_dispatch_init (void)
+{
+    char *name = shmemi_comms_getenv ("SHMEM_REDUCE_ALGORITHM");
+
+    if (EXPR_LIKELY (name == (char *) NULL)) {
+        name = shmemi_locality_available () ?
+            "hierarchical" : default_implementation;
+    }
+
+    if (strcmp (name, "linear") == 0) {
+        use_hierarchical = 0;
+    }
+    else if (strcmp (name, "hierarchical") == 0) {
+        use_hierarchical = 1;
+    }
+    else {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "unsupported reduction \"%s\"",
+                      name);
+        return;
+        /* NOT REACHED */
+    }
+
+    /*
+     * report which reduction implementation we set up
+     */
+    shmemi_trace (SHMEM_LOG_REDUCTION, "using reduction \"%s\"", name);
+}
+
 
 /**
  * pre-defined reductions in SHMEM 1.0
@@ -285,6 +338,104 @@ SHMEM_UDR_TYPE_OP (longdouble, long double);
 SHMEM_UDR_TYPE_OP (complexd, double complex);
 SHMEM_UDR_TYPE_OP (complexf, float complex);
 
+/*
+ * Two-level version: each host's leader combines the sources on its
+ * host through shared memory, the leaders swap their partial results,
+ * and each leader writes the answer straight into its host's targets.
+ * Everyone combines in the same order, so all PEs get the same bits.
+ *
+ * Returns 0 if the set isn't worth (or able) doing this way.
+ */
+
+#define SHMEM_HIER_TYPE_OP(Name, Type)                                  \
+    static                                                              \
+    int                                                                 \
+    shmemi_hier_##Name##_to_all (Type (*the_op)(Type, Type),            \
+                                 Type *target, Type *source, int nreduce, \
+                                 int PE_start, int logPE_stride, int PE_size, \
+                                 long *pSync)                           \
+    {                                                                   \
+        const size_t snred = sizeof(Type) * nreduce;                    \
+        shmemi_locality_t *lp;                                          \
+        int i, j;                                                       \
+        lp = shmemi_locality_lookup (PE_start, logPE_stride, PE_size,   \
+                                     0, pSync);                         \
+        if (lp == NULL) {                                               \
+            return 0;                                                   \
+        }                                                               \
+        /* symmetric, so all PEs agree on this */                       \
+        if (shmemi_locality_ptr (lp, target, lp->lrank) == NULL ||      \
+            shmemi_locality_ptr (lp, source, lp->lrank) == NULL) {      \
+            return 0;                                                   \
+        }                                                               \
+        /* wait for the sources on my host */                           \
+        shmemi_locality_gather (lp, pSync);                             \
+        if (lp->lrank == 0) {                                           \
+            Type *acc = (Type *) malloc (2 * snred);                    \
+            Type *tmp = acc + nreduce;                                  \
+            if (acc == (Type *) NULL) {                                 \
+                shmemi_trace (SHMEM_LOG_FATAL,                          \
+                              "internal error: out of memory"           \
+                              " allocating temporary reduction buffer"  \
+                              );                                        \
+                return 0;                                               \
+                /* NOT REACHED */                                       \
+            }                                                           \
+            memcpy (acc, source, snred);                                \
+            for (i = 1; i < lp->nlocal; i += 1) {                       \
+                const Type *s = shmemi_locality_ptr (lp, source, i);    \
+                for (j = 0; j < nreduce; j += 1) {                      \
+                    acc[j] = (*the_op) (acc[j], s[j]);                  \
+                }                                                       \
+            }                                                           \
+            if (lp->nnodes > 1) {                                       \
+                /* publish my host's part in target, then combine */    \
+                memcpy (target, acc, snred);                            \
+                shmemi_locality_leader_barrier (lp, pSync);             \
+                for (i = 0; i < lp->nnodes; i += 1) {                   \
+                    const Type *part = tmp;                             \
+                    if (i == lp->node) {                                \
+                        part = target;                                  \
+                    }                                                   \
+                    else {                                              \
+                        shmem_getmem (tmp, target, snred, lp->leaders[i]); \
+                    }                                                   \
+                    if (i == 0) {                                       \
+                        memcpy (acc, part, snred);                      \
+                    }                                                   \
+                    else {                                              \
+                        for (j = 0; j < nreduce; j += 1) {              \
+                            acc[j] = (*the_op) (acc[j], part[j]);       \
+                        }                                               \
+                    }                                                   \
+                }                                                       \
+                /* nobody still reading the parts */                    \
+                shmemi_locality_leader_barrier (lp, pSync);             \
+            }                                                           \
+            memcpy (target, acc, snred);                                \
+            for (i = 1; i < lp->nlocal; i += 1) {                       \
+                memcpy (shmemi_locality_ptr (lp, target, i), acc, snred); \
+            }                                                           \
+            free (acc);                                                 \
+            shmemi_trace (SHMEM_LOG_REDUCTION,                          \
+                          "leader combined %d PEs on %d hosts",         \
+                          PE_size, lp->nnodes);                         \
+        }                                                               \
+        /* results are in place */                                      \
+        shmemi_locality_release (lp, pSync);                            \
+        return 1;                                                       \
+    }
+
+SHMEM_HIER_TYPE_OP (short, short);
+SHMEM_HIER_TYPE_OP (int, int);
+SHMEM_HIER_TYPE_OP (long, long);
+SHMEM_HIER_TYPE_OP (longlong, long long);
+SHMEM_HIER_TYPE_OP (double, double);
+SHMEM_HIER_TYPE_OP (float, float);
+SHMEM_HIER_TYPE_OP (longdouble, long double);
+SHMEM_HIER_TYPE_OP (complexd, double complex);
+SHMEM_HIER_TYPE_OP (complexf, float complex);
+
 
 
 
@@ -396,6 +547,13 @@ SHMEM_UDR_TYPE_OP (complexf, float complex);
         INIT_CHECK(debug_name);                                         \
         SYMMETRY_CHECK(target, 1, debug_name);                          \
         SYMMETRY_CHECK(source, 2, debug_name);                          \
+        if (use_hierarchical &&                                         \
+            shmemi_hier_##Name##_to_all(OpCall##_##Name##_func,         \
+                                        target, source, nreduce,        \
+                                        PE_start, logPE_stride, PE_size, \
+                                        pSync)) {                       \
+            return;                                                     \
+        }                                                               \
         shmemi_udr_##Name##_to_all(OpCall##_##Name##_func,              \
                                    target, source, nreduce,             \
                                    PE_start, logPE_stride, PE_size,     \
@@ -446,3 +604,589 @@ SHMEM_REDUCE_TYPE_OP (min, longlong, long long);
 SHMEM_REDUCE_TYPE_OP (min, double, double);
 SHMEM_REDUCE_TYPE_OP (min, float, float);
 SHMEM_REDUCE_TYPE_OP (min, longdouble, long double);
+
+
+#ifdef HAVE_FEATURE_EXPERIMENTAL
+
+/*
+ * Scans (prefix reductions).  Recursive doubling: in round k each PE
+ * combines in the partial result of the PE 2^k places to its left,
+ * so after log2(PE_size) rounds PE i has combined elements 0..i.
+ *
+ * Partial results are exposed in target, and pulled in through pWrk.
+ * A PE tells its right-hand partner when its target is ready to read
+ * (READY), and can't overwrite it until the partner says it's done
+ * (ACK).  Each round has its own pair of pSync slots, cleared by
+ * their owner as soon as they fire.  An exclusive scan is an
+ * inclusive one followed by a shift by one PE, which is just one more
+ * round that copies instead of combining.  The first PE then has
+ * nothing to its left, and gets the operator's identity.
+ *
+ */
+
+#define PAIR_READY_SLOT(k) (2 * (k))
+#define PAIR_ACK_SLOT(k)   (2 * (k) + 1)
+
+#define SHMEM_SCAN_TYPE(Name, Type)                                     \
+    static                                                              \
+    void                                                                \
+    shmemi_scan_##Name (Type (*the_op)(Type, Type),                    \
+                        const Type *identity,                           \
+                        Type *target, Type *source, int nreduce,        \
+                        int PE_start, int logPE_stride, int PE_size,    \
+                        Type *pWrk, long *pSync)                        \
+    {                                                                   \
+        const int me = (GET_STATE (mype) - PE_start) >> logPE_stride;   \
+        const size_t snred = sizeof(Type) * nreduce;                    \
+        const int exclusive = (identity != NULL);                       \
+        Type *next;                                                     \
+        int dist, k;                                                    \
+        int i, j;                                                       \
+        next = (Type *) malloc (snred);                                 \
+        if (EXPR_UNLIKELY (next == (Type *) NULL)) {                    \
+            shmemi_trace (SHMEM_LOG_FATAL,                              \
+                          "internal error: out of memory"               \
+                          " allocating temporary scan buffer"           \
+                          );                                            \
+            return;                                                     \
+            /* NOT REACHED */                                           \
+        }                                                               \
+        if (target != source) {                                         \
+            memcpy (target, source, snred);                             \
+        }                                                               \
+        for (k = 0, dist = 1; ; k += 1, dist <<= 1) {                   \
+            const int last = (dist >= PE_size);                         \
+            const int left = exclusive && last ? me - 1 : me - dist;    \
+            const int right = exclusive && last ? me + 1 : me + dist;   \
+            if (last && ! exclusive) {                                  \
+                break;                                                  \
+            }                                                           \
+            if (right < PE_size) {                                      \
+                shmem_long_p (&pSync[PAIR_READY_SLOT (k)],              \
+                              SHMEM_SYNC_VALUE + 1,                     \
+                              PE_start + (right << logPE_stride));      \
+            }                                                           \
+            if (left >= 0) {                                            \
+                const int pe = PE_start + (left << logPE_stride);       \
+                shmem_long_wait_until (&pSync[PAIR_READY_SLOT (k)],     \
+                                       SHMEM_CMP_NE, SHMEM_SYNC_VALUE); \
+                pSync[PAIR_READY_SLOT (k)] = SHMEM_SYNC_VALUE;          \
+                for (i = 0; i < nreduce;                                \
+                     i += SHMEM_REDUCE_MIN_WRKDATA_SIZE) {              \
+                    int n = nreduce - i;                                \
+                    if (n > SHMEM_REDUCE_MIN_WRKDATA_SIZE) {            \
+                        n = SHMEM_REDUCE_MIN_WRKDATA_SIZE;              \
+                    }                                                   \
+                    shmem_getmem (pWrk, &target[i], n * sizeof(Type), pe); \
+                    for (j = 0; j < n; j += 1) {                        \
+                        next[i + j] = last ? pWrk[j] :                  \
+                            (*the_op) (pWrk[j], target[i + j]);         \
+                    }                                                   \
+                }                                                       \
+                shmem_long_p (&pSync[PAIR_ACK_SLOT (k)],                \
+                              SHMEM_SYNC_VALUE + 1, pe);                \
+            }                                                           \
+            if (right < PE_size) {                                      \
+                shmem_long_wait_until (&pSync[PAIR_ACK_SLOT (k)],       \
+                                       SHMEM_CMP_NE, SHMEM_SYNC_VALUE); \
+                pSync[PAIR_ACK_SLOT (k)] = SHMEM_SYNC_VALUE;            \
+            }                                                           \
+            if (left >= 0) {                                            \
+                memcpy (target, next, snred);                           \
+            }                                                           \
+            if (last) {                                                 \
+                break;                                                  \
+            }                                                           \
+        }                                                               \
+        free (next);                                                    \
+        /* my right-hand partner has ACK'ed, so target is mine again */ \
+        if (exclusive && (me == 0)) {                                   \
+            for (i = 0; i < nreduce; i += 1) {                          \
+                target[i] = *identity;                                  \
+            }                                                           \
+        }                                                               \
+        shmemi_trace (SHMEM_LOG_REDUCTION,                              \
+                      "%s scan over %d PEs took %d rounds",             \
+                      exclusive ? "exclusive" : "inclusive",            \
+                      PE_size, k + exclusive);                          \
+    }
+
+SHMEM_SCAN_TYPE (int, int);
+SHMEM_SCAN_TYPE (long, long);
+SHMEM_SCAN_TYPE (longlong, long long);
+SHMEM_SCAN_TYPE (float, float);
+SHMEM_SCAN_TYPE (double, double);
+
+#ifdef HAVE_FEATURE_PSHMEM
+#pragma weak shmemx_int_sum_inscan = pshmemx_int_sum_inscan
+#define shmemx_int_sum_inscan pshmemx_int_sum_inscan
+#pragma weak shmemx_int_sum_exscan = pshmemx_int_sum_exscan
+#define shmemx_int_sum_exscan pshmemx_int_sum_exscan
+#pragma weak shmemx_long_sum_inscan = pshmemx_long_sum_inscan
+#define shmemx_long_sum_inscan pshmemx_long_sum_inscan
+#pragma weak shmemx_long_sum_exscan = pshmemx_long_sum_exscan
+#define shmemx_long_sum_exscan pshmemx_long_sum_exscan
+#pragma weak shmemx_longlong_sum_inscan = pshmemx_longlong_sum_inscan
+#define shmemx_longlong_sum_inscan pshmemx_longlong_sum_inscan
+#pragma weak shmemx_longlong_sum_exscan = pshmemx_longlong_sum_exscan
+#define shmemx_longlong_sum_exscan pshmemx_longlong_sum_exscan
+#pragma weak shmemx_float_sum_inscan = pshmemx_float_sum_inscan
+#define shmemx_float_sum_inscan pshmemx_float_sum_inscan
+#pragma weak shmemx_float_sum_exscan = pshmemx_float_sum_exscan
+#define shmemx_float_sum_exscan pshmemx_float_sum_exscan
+#pragma weak shmemx_double_sum_inscan = pshmemx_double_sum_inscan
+#define shmemx_double_sum_inscan pshmemx_double_sum_inscan
+#pragma weak shmemx_double_sum_exscan = pshmemx_double_sum_exscan
+#define shmemx_double_sum_exscan pshmemx_double_sum_exscan
+#pragma weak shmemx_int_max_inscan = pshmemx_int_max_inscan
+#define shmemx_int_max_inscan pshmemx_int_max_inscan
+#pragma weak shmemx_int_max_exscan = pshmemx_int_max_exscan
+#define shmemx_int_max_exscan pshmemx_int_max_exscan
+#pragma weak shmemx_long_max_inscan = pshmemx_long_max_inscan
+#define shmemx_long_max_inscan pshmemx_long_max_inscan
+#pragma weak shmemx_long_max_exscan = pshmemx_long_max_exscan
+#define shmemx_long_max_exscan pshmemx_long_max_exscan
+#pragma weak shmemx_longlong_max_inscan = pshmemx_longlong_max_inscan
+#define shmemx_longlong_max_inscan pshmemx_longlong_max_inscan
+#pragma weak shmemx_longlong_max_exscan = pshmemx_longlong_max_exscan
+#define shmemx_longlong_max_exscan pshmemx_longlong_max_exscan
+#pragma weak shmemx_float_max_inscan = pshmemx_float_max_inscan
+#define shmemx_float_max_inscan pshmemx_float_max_inscan
+#pragma weak shmemx_float_max_exscan = pshmemx_float_max_exscan
+#define shmemx_float_max_exscan pshmemx_float_max_exscan
+#pragma weak shmemx_double_max_inscan = pshmemx_double_max_inscan
+#define shmemx_double_max_inscan pshmemx_double_max_inscan
+#pragma weak shmemx_double_max_exscan = pshmemx_double_max_exscan
+#define shmemx_double_max_exscan pshmemx_double_max_exscan
+#pragma weak shmemx_int_min_inscan = pshmemx_int_min_inscan
+#define shmemx_int_min_inscan pshmemx_int_min_inscan
+#pragma weak shmemx_int_min_exscan = pshmemx_int_min_exscan
+#define shmemx_int_min_exscan pshmemx_int_min_exscan
+#pragma weak shmemx_long_min_inscan = pshmemx_long_min_inscan
+#define shmemx_long_min_inscan pshmemx_long_min_inscan
+#pragma weak shmemx_long_min_exscan = pshmemx_long_min_exscan
+#define shmemx_long_min_exscan pshmemx_long_min_exscan
+#pragma weak shmemx_longlong_min_inscan = pshmemx_longlong_min_inscan
+#define shmemx_longlong_min_inscan pshmemx_longlong_min_inscan
+#pragma weak shmemx_longlong_min_exscan = pshmemx_longlong_min_exscan
+#define shmemx_longlong_min_exscan pshmemx_longlong_min_exscan
+#pragma weak shmemx_float_min_inscan = pshmemx_float_min_inscan
+#define shmemx_float_min_inscan pshmemx_float_min_inscan
+#pragma weak shmemx_float_min_exscan = pshmemx_float_min_exscan
+#define shmemx_float_min_exscan pshmemx_float_min_exscan
+#pragma weak shmemx_double_min_inscan = pshmemx_double_min_inscan
+#define shmemx_double_min_inscan pshmemx_double_min_inscan
+#pragma weak shmemx_double_min_exscan = pshmemx_double_min_exscan
+#define shmemx_double_min_exscan pshmemx_double_min_exscan
+#pragma weak shmemx_int_prod_inscan = pshmemx_int_prod_inscan
+#define shmemx_int_prod_inscan pshmemx_int_prod_inscan
+#pragma weak shmemx_int_prod_exscan = pshmemx_int_prod_exscan
+#define shmemx_int_prod_exscan pshmemx_int_prod_exscan
+#pragma weak shmemx_long_prod_inscan = pshmemx_long_prod_inscan
+#define shmemx_long_prod_inscan pshmemx_long_prod_inscan
+#pragma weak shmemx_long_prod_exscan = pshmemx_long_prod_exscan
+#define shmemx_long_prod_exscan pshmemx_long_prod_exscan
+#pragma weak shmemx_longlong_prod_inscan = pshmemx_longlong_prod_inscan
+#define shmemx_longlong_prod_inscan pshmemx_longlong_prod_inscan
+#pragma weak shmemx_longlong_prod_exscan = pshmemx_longlong_prod_exscan
+#define shmemx_longlong_prod_exscan pshmemx_longlong_prod_exscan
+#pragma weak shmemx_float_prod_inscan = pshmemx_float_prod_inscan
+#define shmemx_float_prod_inscan pshmemx_float_prod_inscan
+#pragma weak shmemx_float_prod_exscan = pshmemx_float_prod_exscan
+#define shmemx_float_prod_exscan pshmemx_float_prod_exscan
+#pragma weak shmemx_double_prod_inscan = pshmemx_double_prod_inscan
+#define shmemx_double_prod_inscan pshmemx_double_prod_inscan
+#pragma weak shmemx_double_prod_exscan = pshmemx_double_prod_exscan
+#define shmemx_double_prod_exscan pshmemx_double_prod_exscan
+#endif /* HAVE_FEATURE_PSHMEM */
+
+/*
+ * Identity is what the first PE gets from an exclusive scan
+ */
+
+#define SHMEM_SCAN_TYPE_OP(OpCall, Name, Type, Identity)                \
+    void                                                                \
+    shmemx_##Name##_##OpCall##_inscan (Type *target, Type *source,      \
+                                       int nreduce,                     \
+                                       int PE_start, int logPE_stride,  \
+                                       int PE_size,                     \
+                                       Type *pWrk, long *pSync)         \
+    {                                                                   \
+        DEBUG_NAME ("shmemx_" #Name "_" #OpCall "_inscan");             \
+        INIT_CHECK (debug_name);                                        \
+        SYMMETRY_CHECK (target, 1, debug_name);                         \
+        SYMMETRY_CHECK (pSync, 8, debug_name);                          \
+        shmemi_scan_##Name (OpCall##_##Name##_func, NULL,               \
+                            target, source, nreduce,                    \
+                            PE_start, logPE_stride, PE_size,            \
+                            pWrk, pSync);                               \
+    }                                                                   \
+    void                                                                \
+    shmemx_##Name##_##OpCall##_exscan (Type *target, Type *source,      \
+                                       int nreduce,                     \
+                                       int PE_start, int logPE_stride,  \
+                                       int PE_size,                     \
+                                       Type *pWrk, long *pSync)         \
+    {                                                                   \
+        const Type identity = (Identity);                               \
+        DEBUG_NAME ("shmemx_" #Name "_" #OpCall "_exscan");             \
+        INIT_CHECK (debug_name);                                        \
+        SYMMETRY_CHECK (target, 1, debug_name);                         \
+        SYMMETRY_CHECK (pSync, 8, debug_name);                          \
+        shmemi_scan_##Name (OpCall##_##Name##_func, &identity,          \
+                            target, source, nreduce,                    \
+                            PE_start, logPE_stride, PE_size,            \
+                            pWrk, pSync);                               \
+    }
+
+SHMEM_SCAN_TYPE_OP (sum, int, int, 0);
+SHMEM_SCAN_TYPE_OP (sum, long, long, 0L);
+SHMEM_SCAN_TYPE_OP (sum, longlong, long long, 0LL);
+SHMEM_SCAN_TYPE_OP (sum, float, float, 0.0f);
+SHMEM_SCAN_TYPE_OP (sum, double, double, 0.0);
+SHMEM_SCAN_TYPE_OP (max, int, int, INT_MIN);
+SHMEM_SCAN_TYPE_OP (max, long, long, LONG_MIN);
+SHMEM_SCAN_TYPE_OP (max, longlong, long long, LLONG_MIN);
+SHMEM_SCAN_TYPE_OP (max, float, float, -HUGE_VALF);
+SHMEM_SCAN_TYPE_OP (max, double, double, -HUGE_VAL);
+SHMEM_SCAN_TYPE_OP (min, int, int, INT_MAX);
+SHMEM_SCAN_TYPE_OP (min, long, long, LONG_MAX);
+SHMEM_SCAN_TYPE_OP (min, longlong, long long, LLONG_MAX);
+SHMEM_SCAN_TYPE_OP (min, float, float, HUGE_VALF);
+SHMEM_SCAN_TYPE_OP (min, double, double, HUGE_VAL);
+SHMEM_SCAN_TYPE_OP (prod, int, int, 1);
+SHMEM_SCAN_TYPE_OP (prod, long, long, 1L);
+SHMEM_SCAN_TYPE_OP (prod, longlong, long long, 1LL);
+SHMEM_SCAN_TYPE_OP (prod, float, float, 1.0f);
+SHMEM_SCAN_TYPE_OP (prod, double, double, 1.0);
+
+
+/*
+ * Reduce to one PE: a binomial tree rooted at PE_root (an index into
+ * the set).  Every PE gathers its subtree into its own target, then
+ * tells its parent to pull it; the parent lets the child go once it
+ * has.  Uses the same READY/ACK pSync pairs as the scans, one pair per
+ * level of the tree.  Targets off the root are scratch.
+ *
+ */
+
+#define SHMEM_TO_ROOT_TYPE(Name, Type)                                  \
+    static                                                              \
+    void                                                                \
+    shmemi_to_root_##Name (Type (*the_op)(Type, Type),                  \
+                           Type *target, Type *source, int nreduce,     \
+                           int PE_root, int PE_start, int logPE_stride, \
+                           int PE_size, Type *pWrk, long *pSync)        \
+    {                                                                   \
+        const int me = (GET_STATE (mype) - PE_start) >> logPE_stride;   \
+        const int rel = (me - PE_root + PE_size) % PE_size;             \
+        int mask, k;                                                    \
+        int i, j;                                                       \
+        if (target != source) {                                         \
+            memcpy (target, source, sizeof(Type) * nreduce);            \
+        }                                                               \
+        for (k = 0, mask = 1; mask < PE_size; k += 1, mask <<= 1) {     \
+            if (rel & mask) {                                           \
+                const int parent = (rel - mask + PE_root) % PE_size;    \
+                shmem_long_p (&pSync[PAIR_READY_SLOT (k)],              \
+                              SHMEM_SYNC_VALUE + 1,                     \
+                              PE_start + (parent << logPE_stride));     \
+                shmem_long_wait_until (&pSync[PAIR_ACK_SLOT (k)],       \
+                                       SHMEM_CMP_NE, SHMEM_SYNC_VALUE); \
+                pSync[PAIR_ACK_SLOT (k)] = SHMEM_SYNC_VALUE;            \
+                break;                                                  \
+            }                                                           \
+            if (rel + mask < PE_size) {                                 \
+                const int child = (rel + mask + PE_root) % PE_size;     \
+                const int pe = PE_start + (child << logPE_stride);      \
+                shmem_long_wait_until (&pSync[PAIR_READY_SLOT (k)],     \
+                                       SHMEM_CMP_NE, SHMEM_SYNC_VALUE); \
+                pSync[PAIR_READY_SLOT (k)] = SHMEM_SYNC_VALUE;          \
+                for (i = 0; i < nreduce;                                \
+                     i += SHMEM_REDUCE_MIN_WRKDATA_SIZE) {              \
+                    int n = nreduce - i;                                \
+                    if (n > SHMEM_REDUCE_MIN_WRKDATA_SIZE) {            \
+                        n = SHMEM_REDUCE_MIN_WRKDATA_SIZE;              \
+                    }                                                   \
+                    shmem_getmem (pWrk, &target[i], n * sizeof(Type), pe); \
+                    for (j = 0; j < n; j += 1) {                        \
+                        target[i + j] =                                 \
+                            (*the_op) (target[i + j], pWrk[j]);         \
+                    }                                                   \
+                }                                                       \
+                shmem_long_p (&pSync[PAIR_ACK_SLOT (k)],                \
+                              SHMEM_SYNC_VALUE + 1, pe);                \
+            }                                                           \
+        }                                                               \
+    }
+
+/*
+ * Reduce-scatter: source holds PE_size blocks of nreduce elements,
+ * and block i of the result ends up in target on the i'th PE of the
+ * set.  Ring algorithm: in PE_size - 1 steps each PE pulls its left
+ * neighbour's partial sum of one block out of the neighbour's target
+ * and adds its own part, so each PE moves (PE_size - 1) blocks instead
+ * of everyone's everything.  Steps are in lockstep with the
+ * neighbours, so one READY/ACK pair counting the steps is enough.
+ *
+ */
+
+#define SHMEM_REDUCE_SCATTER_TYPE(Name, Type)                           \
+    static                                                              \
+    void                                                                \
+    shmemi_reduce_scatter_##Name (Type (*the_op)(Type, Type),           \
+                                  Type *target, Type *source,           \
+                                  int nreduce,                          \
+                                  int PE_start, int logPE_stride,       \
+                                  int PE_size, Type *pWrk, long *pSync) \
+    {                                                                   \
+        const int me = (GET_STATE (mype) - PE_start) >> logPE_stride;   \
+        const int left = PE_start +                                     \
+            (((me + PE_size - 1) % PE_size) << logPE_stride);           \
+        const int right = PE_start +                                    \
+            (((me + 1) % PE_size) << logPE_stride);                     \
+        const size_t snred = sizeof(Type) * nreduce;                    \
+        Type *next;                                                     \
+        int step;                                                       \
+        int i, j;                                                       \
+        next = (Type *) malloc (snred);                                 \
+        if (EXPR_UNLIKELY (next == (Type *) NULL)) {                    \
+            shmemi_trace (SHMEM_LOG_FATAL,                              \
+                          "internal error: out of memory"               \
+                          " allocating temporary reduction buffer"      \
+                          );                                            \
+            return;                                                     \
+            /* NOT REACHED */                                           \
+        }                                                               \
+        /* start with the block that ends up on my right */             \
+        memcpy (target,                                                 \
+                &source[((me + PE_size - 1) % PE_size) * nreduce],      \
+                snred);                                                 \
+        for (step = 1; step < PE_size; step += 1) {                     \
+            const Type *mine =                                          \
+                &source[((me + PE_size - 1 - step) % PE_size) * nreduce]; \
+            shmem_long_p (&pSync[PAIR_READY_SLOT (0)],                  \
+                          SHMEM_SYNC_VALUE + step, right);              \
+            shmem_long_wait_until (&pSync[PAIR_READY_SLOT (0)],         \
+                                   SHMEM_CMP_GE,                        \
+                                   SHMEM_SYNC_VALUE + step);            \
+            /* clear before anyone can start the next call */           \
+            if (step == PE_size - 1) {                                  \
+                pSync[PAIR_READY_SLOT (0)] = SHMEM_SYNC_VALUE;          \
+            }                                                           \
+            for (i = 0; i < nreduce;                                    \
+                 i += SHMEM_REDUCE_MIN_WRKDATA_SIZE) {                  \
+                int n = nreduce - i;                                    \
+                if (n > SHMEM_REDUCE_MIN_WRKDATA_SIZE) {                \
+                    n = SHMEM_REDUCE_MIN_WRKDATA_SIZE;                  \
+                }                                                       \
+                shmem_getmem (pWrk, &target[i], n * sizeof(Type), left); \
+                for (j = 0; j < n; j += 1) {                            \
+                    next[i + j] = (*the_op) (pWrk[j], mine[i + j]);     \
+                }                                                       \
+            }                                                           \
+            shmem_long_p (&pSync[PAIR_ACK_SLOT (0)],                    \
+                          SHMEM_SYNC_VALUE + step, left);               \
+            shmem_long_wait_until (&pSync[PAIR_ACK_SLOT (0)],           \
+                                   SHMEM_CMP_GE,                        \
+                                   SHMEM_SYNC_VALUE + step);            \
+            if (step == PE_size - 1) {                                  \
+                pSync[PAIR_ACK_SLOT (0)] = SHMEM_SYNC_VALUE;            \
+            }                                                           \
+            memcpy (target, next, snred);                               \
+        }                                                               \
+        free (next);                                                    \
+    }
+
+SHMEM_TO_ROOT_TYPE (short, short);
+SHMEM_TO_ROOT_TYPE (int, int);
+SHMEM_TO_ROOT_TYPE (long, long);
+SHMEM_TO_ROOT_TYPE (longlong, long long);
+SHMEM_TO_ROOT_TYPE (double, double);
+SHMEM_TO_ROOT_TYPE (float, float);
+SHMEM_TO_ROOT_TYPE (longdouble, long double);
+SHMEM_TO_ROOT_TYPE (complexd, double complex);
+SHMEM_TO_ROOT_TYPE (complexf, float complex);
+
+SHMEM_REDUCE_SCATTER_TYPE (short, short);
+SHMEM_REDUCE_SCATTER_TYPE (int, int);
+SHMEM_REDUCE_SCATTER_TYPE (long, long);
+SHMEM_REDUCE_SCATTER_TYPE (longlong, long long);
+SHMEM_REDUCE_SCATTER_TYPE (double, double);
+SHMEM_REDUCE_SCATTER_TYPE (float, float);
+SHMEM_REDUCE_SCATTER_TYPE (longdouble, long double);
+SHMEM_REDUCE_SCATTER_TYPE (complexd, double complex);
+SHMEM_REDUCE_SCATTER_TYPE (complexf, float complex);
+
+#ifdef HAVE_FEATURE_PSHMEM
+#pragma weak shmemx_short_sum_to_root = pshmemx_short_sum_to_root
+#define shmemx_short_sum_to_root pshmemx_short_sum_to_root
+#pragma weak shmemx_short_sum_reduce_scatter = pshmemx_short_sum_reduce_scatter
+#define shmemx_short_sum_reduce_scatter pshmemx_short_sum_reduce_scatter
+#pragma weak shmemx_int_sum_to_root = pshmemx_int_sum_to_root
+#define shmemx_int_sum_to_root pshmemx_int_sum_to_root
+#pragma weak shmemx_int_sum_reduce_scatter = pshmemx_int_sum_reduce_scatter
+#define shmemx_int_sum_reduce_scatter pshmemx_int_sum_reduce_scatter
+#pragma weak shmemx_long_sum_to_root = pshmemx_long_sum_to_root
+#define shmemx_long_sum_to_root pshmemx_long_sum_to_root
+#pragma weak shmemx_long_sum_reduce_scatter = pshmemx_long_sum_reduce_scatter
+#define shmemx_long_sum_reduce_scatter pshmemx_long_sum_reduce_scatter
+#pragma weak shmemx_longlong_sum_to_root = pshmemx_longlong_sum_to_root
+#define shmemx_longlong_sum_to_root pshmemx_longlong_sum_to_root
+#pragma weak shmemx_longlong_sum_reduce_scatter = pshmemx_longlong_sum_reduce_scatter
+#define shmemx_longlong_sum_reduce_scatter pshmemx_longlong_sum_reduce_scatter
+#pragma weak shmemx_double_sum_to_root = pshmemx_double_sum_to_root
+#define shmemx_double_sum_to_root pshmemx_double_sum_to_root
+#pragma weak shmemx_double_sum_reduce_scatter = pshmemx_double_sum_reduce_scatter
+#define shmemx_double_sum_reduce_scatter pshmemx_double_sum_reduce_scatter
+#pragma weak shmemx_float_sum_to_root = pshmemx_float_sum_to_root
+#define shmemx_float_sum_to_root pshmemx_float_sum_to_root
+#pragma weak shmemx_float_sum_reduce_scatter = pshmemx_float_sum_reduce_scatter
+#define shmemx_float_sum_reduce_scatter pshmemx_float_sum_reduce_scatter
+#pragma weak shmemx_longdouble_sum_to_root = pshmemx_longdouble_sum_to_root
+#define shmemx_longdouble_sum_to_root pshmemx_longdouble_sum_to_root
+#pragma weak shmemx_longdouble_sum_reduce_scatter = pshmemx_longdouble_sum_reduce_scatter
+#define shmemx_longdouble_sum_reduce_scatter pshmemx_longdouble_sum_reduce_scatter
+#pragma weak shmemx_complexd_sum_to_root = pshmemx_complexd_sum_to_root
+#define shmemx_complexd_sum_to_root pshmemx_complexd_sum_to_root
+#pragma weak shmemx_complexd_sum_reduce_scatter = pshmemx_complexd_sum_reduce_scatter
+#define shmemx_complexd_sum_reduce_scatter pshmemx_complexd_sum_reduce_scatter
+#pragma weak shmemx_complexf_sum_to_root = pshmemx_complexf_sum_to_root
+#define shmemx_complexf_sum_to_root pshmemx_complexf_sum_to_root
+#pragma weak shmemx_complexf_sum_reduce_scatter = pshmemx_complexf_sum_reduce_scatter
+#define shmemx_complexf_sum_reduce_scatter pshmemx_complexf_sum_reduce_scatter
+#endif /* HAVE_FEATURE_PSHMEM */
+
+#define SHMEM_ROOTED_TYPE_OP(OpCall, Name, Type)                        \
+    void                                                                \
+    shmemx_##Name##_##OpCall##_to_root (Type *target, Type *source,     \
+                                        int nreduce, int PE_root,       \
+                                        int PE_start, int logPE_stride, \
+                                        int PE_size,                    \
+                                        Type *pWrk, long *pSync)        \
+    {                                                                   \
+        DEBUG_NAME ("shmemx_" #Name "_" #OpCall "_to_root");            \
+        INIT_CHECK (debug_name);                                        \
+        SYMMETRY_CHECK (target, 1, debug_name);                         \
+        SYMMETRY_CHECK (pSync, 9, debug_name);                          \
+        shmemi_to_root_##Name (OpCall##_##Name##_func,                  \
+                               target, source, nreduce,                 \
+                               PE_root, PE_start, logPE_stride, PE_size, \
+                               pWrk, pSync);                            \
+    }                                                                   \
+    void                                                                \
+    shmemx_##Name##_##OpCall##_reduce_scatter (Type *target,            \
+                                               Type *source,            \
+                                               int nreduce,             \
+                                               int PE_start,            \
+                                               int logPE_stride,        \
+                                               int PE_size,             \
+                                               Type *pWrk,              \
+                                               long *pSync)             \
+    {                                                                   \
+        DEBUG_NAME ("shmemx_" #Name "_" #OpCall "_reduce_scatter");     \
+        INIT_CHECK (debug_name);                                        \
+        SYMMETRY_CHECK (target, 1, debug_name);                         \
+        SYMMETRY_CHECK (pSync, 8, debug_name);                          \
+        shmemi_reduce_scatter_##Name (OpCall##_##Name##_func,           \
+                                      target, source, nreduce,          \
+                                      PE_start, logPE_stride, PE_size,  \
+                                      pWrk, pSync);                     \
+    }
+
+SHMEM_ROOTED_TYPE_OP (sum, short, short);
+SHMEM_ROOTED_TYPE_OP (sum, int, int);
+SHMEM_ROOTED_TYPE_OP (sum, long, long);
+SHMEM_ROOTED_TYPE_OP (sum, longlong, long long);
+SHMEM_ROOTED_TYPE_OP (sum, double, double);
+SHMEM_ROOTED_TYPE_OP (sum, float, float);
+SHMEM_ROOTED_TYPE_OP (sum, longdouble, long double);
+SHMEM_ROOTED_TYPE_OP (sum, complexd, double complex);
+SHMEM_ROOTED_TYPE_OP (sum, complexf, float complex);
+
+/*
+ * User-defined reduction: elements are just elem_size bytes, and "op"
+ * folds a vector of them at a time into the running result.  PEs are
+ * combined strictly in set order starting from the first one, so
+ * every PE gets the same answer even if op only associates.
+ *
+ */
+
+#ifdef HAVE_FEATURE_PSHMEM
+#pragma weak shmemx_reduce_udr = pshmemx_reduce_udr
+#define shmemx_reduce_udr pshmemx_reduce_udr
+#endif /* HAVE_FEATURE_PSHMEM */
+
+void
+shmemx_reduce_udr (void *target, const void *source,
+                   size_t nreduce, size_t elem_size,
+                   void (*op) (void *inout, const void *in, size_t n),
+                   int PE_start, int logPE_stride, int PE_size,
+                   void *pWrk, long *pSync)
+{
+    DEBUG_NAME ("shmemx_reduce_udr");
+    const int step = 1 << logPE_stride;
+    const size_t snred = elem_size * nreduce;
+    const size_t chunk = SHMEM_REDUCE_MIN_WRKDATA_SIZE * elem_size;
+    const char *src = (const char *) source;
+    char *write_to = (char *) target;
+    char *tmptrg = NULL;
+    size_t off;
+    int i, pe;
+
+    INIT_CHECK (debug_name);
+    SYMMETRY_CHECK (target, 1, debug_name);
+    SYMMETRY_CHECK (source, 2, debug_name);
+    SYMMETRY_CHECK (pSync, 10, debug_name);
+
+    /* others read my source while I build the result */
+    if (OVERLAP_CHECK (write_to, src, snred)) {
+        tmptrg = (char *) malloc (snred);
+        if (EXPR_UNLIKELY (tmptrg == (char *) NULL)) {
+            shmemi_trace (SHMEM_LOG_FATAL,
+                          "internal error: out of memory"
+                          " allocating temporary reduction buffer");
+            return;
+            /* NOT REACHED */
+        }
+        write_to = tmptrg;
+    }
+
+    shmem_barrier (PE_start, logPE_stride, PE_size, pSync);
+
+    for (i = 0, pe = PE_start; i < PE_size; i += 1, pe += step) {
+        for (off = 0; off < snred; off += chunk) {
+            const size_t nget = (snred - off < chunk) ? snred - off : chunk;
+            const void *in;
+
+            if (pe == GET_STATE (mype)) {
+                in = src + off;
+            }
+            else {
+                shmem_getmem (pWrk, src + off, nget, pe);
+                in = pWrk;
+            }
+
+            if (i == 0) {
+                memcpy (write_to + off, in, nget);
+            }
+            else {
+                (*op) (write_to + off, in, nget / elem_size);
+            }
+        }
+    }
+
+    /* everyone has to have finished */
+    shmem_barrier (PE_start, logPE_stride, PE_size, pSync);
+
+    if (tmptrg != NULL) {
+        memcpy (target, tmptrg, snred);
+        free (tmptrg);
+    }
+
+    shmemi_trace (SHMEM_LOG_REDUCTION,
+                  "user-defined reduction of %ld x %ld bytes over %d PEs",
+                  (long) nreduce, (long) elem_size, PE_size);
+}
+
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
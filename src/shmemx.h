@@ -139,6 +139,76 @@ extern "C"
 #define shmemx_malloc_nb(s)   shmalloc_nb(s)
 #define shmemx_free_nb(a)     shfree_nb(a)
 
+    /**
+     * @brief symmetric arenas: carve many temporary symmetric
+     * buffers out of one allocation
+     *
+     * @section Synopsis:
+     *
+     * @substitute c C/C++
+     * @code
+     shmemx_arena_t shmemx_arena_create (size_t size);
+     void *shmemx_arena_alloc (shmemx_arena_t arena, size_t size,
+                               size_t align);
+     void shmemx_arena_reset (shmemx_arena_t arena);
+     void shmemx_arena_destroy (shmemx_arena_t arena);
+     * @endcode
+     *
+     * shmemx_arena_create is collective and takes size bytes of
+     * symmetric heap.  shmemx_arena_alloc is local: it hands out the
+     * next size bytes of the arena, aligned to align (a power of 2 up
+     * to 4096, or 0 for the default), with no barrier.  Blocks are symmetric
+     * as long as all PEs allocate the same sizes in the same order.
+     * shmemx_arena_reset is collective and releases every block at
+     * once; shmemx_arena_destroy is collective and gives the memory
+     * back to the heap.
+     *
+     * @return shmemx_arena_create returns SHMEMX_ARENA_INVALID and
+     * shmemx_arena_alloc NULL if there isn't enough memory.
+     *
+     */
+
+    typedef struct shmemi_arena *shmemx_arena_t;
+
+#define SHMEMX_ARENA_INVALID ((shmemx_arena_t) 0)
+
+    shmemx_arena_t shmemx_arena_create (size_t size);
+    void *shmemx_arena_alloc (shmemx_arena_t arena, size_t size,
+                              size_t align) _WUR;
+    void shmemx_arena_reset (shmemx_arena_t arena);
+    void shmemx_arena_destroy (shmemx_arena_t arena);
+
+    /**
+     * @brief how full the calling PE's symmetric heap is
+     *
+     * @section Synopsis:
+     *
+     * @substitute c C/C++
+     * @code
+     void shmemx_heap_stats (struct shmemx_heap_stats *stats);
+     * @endcode
+     *
+     * Local, no communication.  Sizes are in bytes and count whole
+     * blocks, as handed out by the allocator.  fragmentation is
+     * 1 - largest_free / free: 0 when all the free space is in one
+     * piece, close to 1 when it is scattered in small pieces.
+     *
+     */
+
+    struct shmemx_heap_stats
+    {
+        size_t heap_size;       /* current size of the heap */
+        size_t inuse;           /* in allocated blocks */
+        size_t free;            /* available for allocation */
+        size_t largest_free;    /* biggest single free block */
+        size_t peak;            /* most ever in use */
+        unsigned long nallocs;  /* allocations so far */
+        unsigned long nblocks;  /* blocks allocated now */
+        double fragmentation;   /* 1 - largest_free / free */
+    };
+
+    void shmemx_heap_stats (struct shmemx_heap_stats *stats);
+
     /*
      * Proposed by IBM Zurich
      *
@@ -314,6 +384,726 @@ extern "C"
 
     int shmemx_quiet_test (void);
 
+    /*
+     * teams
+     *
+     */
+
+    /**
+     * @brief A team is a subset of the PEs that collectives can be
+     * run over without the caller managing pSync or pWrk arrays.
+     *
+     * @section Synopsis:
+     *
+     * @substitute c C/C++
+     * @code
+     int shmemx_team_split_strided (shmemx_team_t parent,
+                                    int start, int stride, int size,
+                                    shmemx_team_t *newteam);
+     int shmemx_team_split_2d (shmemx_team_t parent, int xrange,
+                               shmemx_team_t *xaxis, shmemx_team_t *yaxis);
+     void shmemx_team_destroy (shmemx_team_t team);
+     * @endcode
+     *
+     * Splitting is collective over the parent team.  start, stride
+     * and size are in parent-team ranks; PEs not in the new team get
+     * SHMEMX_TEAM_INVALID.  split_2d puts every parent PE into one row
+     * of xrange PEs (xaxis) and one column (yaxis).  Teams here are
+     * sets of world PEs whose stride is a power of 2, and a PE can be
+     * in at most 64 teams at once.
+     *
+     * Team collectives take team ranks for roots.  Each team keeps a
+     * small pool of sync arrays so back-to-back collectives do not
+     * need a barrier between them.
+     *
+     * @return split routines return 0 on success, non-zero otherwise
+     * (the same on all PEs of the parent).
+     *
+     */
+
+    typedef struct shmemi_team *shmemx_team_t;
+
+#define SHMEMX_TEAM_INVALID ((shmemx_team_t) 0)
+
+    extern shmemx_team_t shmemx_team_world;
+
+#define SHMEMX_TEAM_WORLD shmemx_team_world
+
+    int shmemx_team_my_pe (shmemx_team_t team);
+    int shmemx_team_n_pes (shmemx_team_t team);
+    int shmemx_team_translate_pe (shmemx_team_t src_team, int src_pe,
+                                  shmemx_team_t dest_team);
+
+    int shmemx_team_split_strided (shmemx_team_t parent,
+                                   int start, int stride, int size,
+                                   shmemx_team_t *newteam);
+    int shmemx_team_split_2d (shmemx_team_t parent, int xrange,
+                              shmemx_team_t *xaxis, shmemx_team_t *yaxis);
+    void shmemx_team_destroy (shmemx_team_t team);
+
+    void shmemx_team_barrier (shmemx_team_t team);
+    void shmemx_team_broadcast32 (shmemx_team_t team,
+                                  void *target, const void *source,
+                                  size_t nelems, int PE_root);
+    void shmemx_team_broadcast64 (shmemx_team_t team,
+                                  void *target, const void *source,
+                                  size_t nelems, int PE_root);
+    void shmemx_team_fcollect32 (shmemx_team_t team,
+                                 void *target, const void *source,
+                                 size_t nelems);
+    void shmemx_team_fcollect64 (shmemx_team_t team,
+                                 void *target, const void *source,
+                                 size_t nelems);
+    void shmemx_team_alltoall32 (shmemx_team_t team,
+                                 void *target, const void *source,
+                                 size_t nelems);
+    void shmemx_team_alltoall64 (shmemx_team_t team,
+                                 void *target, const void *source,
+                                 size_t nelems);
+
+    void shmemx_team_int_sum_reduce (shmemx_team_t team,
+                                     int *target, const int *source,
+                                     int nreduce);
+    void shmemx_team_long_sum_reduce (shmemx_team_t team,
+                                      long *target, const long *source,
+                                      int nreduce);
+    void shmemx_team_longlong_sum_reduce (shmemx_team_t team,
+                                          long long *target, const long long *source,
+                                          int nreduce);
+    void shmemx_team_float_sum_reduce (shmemx_team_t team,
+                                       float *target, const float *source,
+                                       int nreduce);
+    void shmemx_team_double_sum_reduce (shmemx_team_t team,
+                                        double *target, const double *source,
+                                        int nreduce);
+    void shmemx_team_int_prod_reduce (shmemx_team_t team,
+                                      int *target, const int *source,
+                                      int nreduce);
+    void shmemx_team_long_prod_reduce (shmemx_team_t team,
+                                       long *target, const long *source,
+                                       int nreduce);
+    void shmemx_team_longlong_prod_reduce (shmemx_team_t team,
+                                           long long *target, const long long *source,
+                                           int nreduce);
+    void shmemx_team_float_prod_reduce (shmemx_team_t team,
+                                        float *target, const float *source,
+                                        int nreduce);
+    void shmemx_team_double_prod_reduce (shmemx_team_t team,
+                                         double *target, const double *source,
+                                         int nreduce);
+    void shmemx_team_int_min_reduce (shmemx_team_t team,
+                                     int *target, const int *source,
+                                     int nreduce);
+    void shmemx_team_long_min_reduce (shmemx_team_t team,
+                                      long *target, const long *source,
+                                      int nreduce);
+    void shmemx_team_longlong_min_reduce (shmemx_team_t team,
+                                          long long *target, const long long *source,
+                                          int nreduce);
+    void shmemx_team_float_min_reduce (shmemx_team_t team,
+                                       float *target, const float *source,
+                                       int nreduce);
+    void shmemx_team_double_min_reduce (shmemx_team_t team,
+                                        double *target, const double *source,
+                                        int nreduce);
+    void shmemx_team_int_max_reduce (shmemx_team_t team,
+                                     int *target, const int *source,
+                                     int nreduce);
+    void shmemx_team_long_max_reduce (shmemx_team_t team,
+                                      long *target, const long *source,
+                                      int nreduce);
+    void shmemx_team_longlong_max_reduce (shmemx_team_t team,
+                                          long long *target, const long long *source,
+                                          int nreduce);
+    void shmemx_team_float_max_reduce (shmemx_team_t team,
+                                       float *target, const float *source,
+                                       int nreduce);
+    void shmemx_team_double_max_reduce (shmemx_team_t team,
+                                        double *target, const double *source,
+                                        int nreduce);
+    void shmemx_team_int_and_reduce (shmemx_team_t team,
+                                     int *target, const int *source,
+                                     int nreduce);
+    void shmemx_team_long_and_reduce (shmemx_team_t team,
+                                      long *target, const long *source,
+                                      int nreduce);
+    void shmemx_team_longlong_and_reduce (shmemx_team_t team,
+                                          long long *target, const long long *source,
+                                          int nreduce);
+    void shmemx_team_int_or_reduce (shmemx_team_t team,
+                                    int *target, const int *source,
+                                    int nreduce);
+    void shmemx_team_long_or_reduce (shmemx_team_t team,
+                                     long *target, const long *source,
+                                     int nreduce);
+    void shmemx_team_longlong_or_reduce (shmemx_team_t team,
+                                         long long *target, const long long *source,
+                                         int nreduce);
+    void shmemx_team_int_xor_reduce (shmemx_team_t team,
+                                     int *target, const int *source,
+                                     int nreduce);
+    void shmemx_team_long_xor_reduce (shmemx_team_t team,
+                                      long *target, const long *source,
+                                      int nreduce);
+    void shmemx_team_longlong_xor_reduce (shmemx_team_t team,
+                                          long long *target, const long long *source,
+                                          int nreduce);
+
+    /*
+     * non-blocking collectives
+     *
+     */
+
+    /**
+     * @brief start a collective and return at once with a handle to
+     * complete it with shmemx_wait_req() or shmemx_test_req()
+     *
+     * @section Synopsis:
+     *
+     * @substitute c C/C++
+     * @code
+     void shmemx_barrier_all_nb (shmemx_request_handle_t *desc);
+     void shmemx_broadcast64_nb (void *target, const void *source,
+                                 size_t nelems, int PE_root, int PE_start,
+                                 int logPE_stride, int PE_size, long *pSync,
+                                 shmemx_request_handle_t *desc);
+     void shmemx_fcollect64_nb (void *target, const void *source,
+                                size_t nelems, int PE_start,
+                                int logPE_stride, int PE_size, long *pSync,
+                                shmemx_request_handle_t *desc);
+     void shmemx_long_sum_to_all_nb (long *target, long *source, int nreduce,
+                                     int PE_start, int logPE_stride,
+                                     int PE_size, long *pWrk, long *pSync,
+                                     shmemx_request_handle_t *desc);
+     * @endcode
+     *
+     * Arguments are as for the blocking routines.  Collectives make
+     * progress when any collective handle is tested or waited on, and
+     * in the background if the library runs a progress thread.  They
+     * complete in the order they were started, which must be the same
+     * on all PEs of an active set.  source, target and pSync must not
+     * be touched until the request completes; pSync can be reused as
+     * soon as it has.  A handle is no longer valid once wait or test
+     * has reported it complete.
+     *
+     */
+
+    void shmemx_barrier_all_nb (shmemx_request_handle_t *desc);
+    void shmemx_broadcast32_nb (void *target, const void *source,
+                                size_t nelems, int PE_root, int PE_start,
+                                int logPE_stride, int PE_size, long *pSync,
+                                shmemx_request_handle_t *desc);
+    void shmemx_broadcast64_nb (void *target, const void *source,
+                                size_t nelems, int PE_root, int PE_start,
+                                int logPE_stride, int PE_size, long *pSync,
+                                shmemx_request_handle_t *desc);
+    void shmemx_fcollect32_nb (void *target, const void *source,
+                               size_t nelems, int PE_start,
+                               int logPE_stride, int PE_size, long *pSync,
+                               shmemx_request_handle_t *desc);
+    void shmemx_fcollect64_nb (void *target, const void *source,
+                               size_t nelems, int PE_start,
+                               int logPE_stride, int PE_size, long *pSync,
+                               shmemx_request_handle_t *desc);
+    void shmemx_short_sum_to_all_nb (short *target,
+                                     short *source, int nreduce,
+                                     int PE_start, int logPE_stride,
+                                     int PE_size, short *pWrk,
+                                     long *pSync,
+                                     shmemx_request_handle_t *desc);
+    void shmemx_int_sum_to_all_nb (int *target,
+                                   int *source, int nreduce,
+                                   int PE_start, int logPE_stride,
+                                   int PE_size, int *pWrk,
+                                   long *pSync,
+                                   shmemx_request_handle_t *desc);
+    void shmemx_long_sum_to_all_nb (long *target,
+                                    long *source, int nreduce,
+                                    int PE_start, int logPE_stride,
+                                    int PE_size, long *pWrk,
+                                    long *pSync,
+                                    shmemx_request_handle_t *desc);
+    void shmemx_longlong_sum_to_all_nb (long long *target,
+                                        long long *source, int nreduce,
+                                        int PE_start, int logPE_stride,
+                                        int PE_size, long long *pWrk,
+                                        long *pSync,
+                                        shmemx_request_handle_t *desc);
+    void shmemx_double_sum_to_all_nb (double *target,
+                                      double *source, int nreduce,
+                                      int PE_start, int logPE_stride,
+                                      int PE_size, double *pWrk,
+                                      long *pSync,
+                                      shmemx_request_handle_t *desc);
+    void shmemx_float_sum_to_all_nb (float *target,
+                                     float *source, int nreduce,
+                                     int PE_start, int logPE_stride,
+                                     int PE_size, float *pWrk,
+                                     long *pSync,
+                                     shmemx_request_handle_t *desc);
+    void shmemx_longdouble_sum_to_all_nb (long double *target,
+                                          long double *source, int nreduce,
+                                          int PE_start, int logPE_stride,
+                                          int PE_size, long double *pWrk,
+                                          long *pSync,
+                                          shmemx_request_handle_t *desc);
+    void shmemx_complexd_sum_to_all_nb (COMPLEXIFY (double) * target,
+                                        COMPLEXIFY (double) * source, int nreduce,
+                                        int PE_start, int logPE_stride,
+                                        int PE_size, COMPLEXIFY (double) * pWrk,
+                                        long *pSync,
+                                        shmemx_request_handle_t *desc);
+    void shmemx_complexf_sum_to_all_nb (COMPLEXIFY (float) * target,
+                                        COMPLEXIFY (float) * source, int nreduce,
+                                        int PE_start, int logPE_stride,
+                                        int PE_size, COMPLEXIFY (float) * pWrk,
+                                        long *pSync,
+                                        shmemx_request_handle_t *desc);
+
+    /*
+     * scans
+     *
+     */
+
+    /**
+     * @brief prefix reductions over an active set.  After an inclusive
+     * scan, target on the i'th PE of the set holds source combined
+     * over PEs 0..i of the set; after an exclusive scan, over PEs
+     * 0..i-1.
+     *
+     * @section Synopsis:
+     *
+     * @substitute c C/C++
+     * @code
+     void shmemx_long_sum_inscan (long *target, long *source,
+                                  int nreduce, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  long *pWrk, long *pSync);
+     void shmemx_long_sum_exscan (long *target, long *source,
+                                  int nreduce, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  long *pWrk, long *pSync);
+     * @endcode
+     *
+     * Available for int, long, longlong, float and double with sum,
+     * max, min and prod.  Arguments are as for the *_to_all
+     * reductions, and target and source may be the same array.  In
+     * an exclusive scan, target on the first PE of the set gets the
+     * operator's identity: 0 for sum, 1 for prod, the type's largest
+     * value for min and its smallest for max (infinities for float
+     * and double).
+     *
+     */
+    void shmemx_int_sum_inscan (int *target, int *source,
+                                int nreduce, int PE_start,
+                                int logPE_stride, int PE_size,
+                                int *pWrk, long *pSync);
+    void shmemx_int_sum_exscan (int *target, int *source,
+                                int nreduce, int PE_start,
+                                int logPE_stride, int PE_size,
+                                int *pWrk, long *pSync);
+    void shmemx_long_sum_inscan (long *target, long *source,
+                                 int nreduce, int PE_start,
+                                 int logPE_stride, int PE_size,
+                                 long *pWrk, long *pSync);
+    void shmemx_long_sum_exscan (long *target, long *source,
+                                 int nreduce, int PE_start,
+                                 int logPE_stride, int PE_size,
+                                 long *pWrk, long *pSync);
+    void shmemx_longlong_sum_inscan (long long *target, long long *source,
+                                     int nreduce, int PE_start,
+                                     int logPE_stride, int PE_size,
+                                     long long *pWrk, long *pSync);
+    void shmemx_longlong_sum_exscan (long long *target, long long *source,
+                                     int nreduce, int PE_start,
+                                     int logPE_stride, int PE_size,
+                                     long long *pWrk, long *pSync);
+    void shmemx_float_sum_inscan (float *target, float *source,
+                                  int nreduce, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  float *pWrk, long *pSync);
+    void shmemx_float_sum_exscan (float *target, float *source,
+                                  int nreduce, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  float *pWrk, long *pSync);
+    void shmemx_double_sum_inscan (double *target, double *source,
+                                   int nreduce, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   double *pWrk, long *pSync);
+    void shmemx_double_sum_exscan (double *target, double *source,
+                                   int nreduce, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   double *pWrk, long *pSync);
+    void shmemx_int_max_inscan (int *target, int *source,
+                                int nreduce, int PE_start,
+                                int logPE_stride, int PE_size,
+                                int *pWrk, long *pSync);
+    void shmemx_int_max_exscan (int *target, int *source,
+                                int nreduce, int PE_start,
+                                int logPE_stride, int PE_size,
+                                int *pWrk, long *pSync);
+    void shmemx_long_max_inscan (long *target, long *source,
+                                 int nreduce, int PE_start,
+                                 int logPE_stride, int PE_size,
+                                 long *pWrk, long *pSync);
+    void shmemx_long_max_exscan (long *target, long *source,
+                                 int nreduce, int PE_start,
+                                 int logPE_stride, int PE_size,
+                                 long *pWrk, long *pSync);
+    void shmemx_longlong_max_inscan (long long *target, long long *source,
+                                     int nreduce, int PE_start,
+                                     int logPE_stride, int PE_size,
+                                     long long *pWrk, long *pSync);
+    void shmemx_longlong_max_exscan (long long *target, long long *source,
+                                     int nreduce, int PE_start,
+                                     int logPE_stride, int PE_size,
+                                     long long *pWrk, long *pSync);
+    void shmemx_float_max_inscan (float *target, float *source,
+                                  int nreduce, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  float *pWrk, long *pSync);
+    void shmemx_float_max_exscan (float *target, float *source,
+                                  int nreduce, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  float *pWrk, long *pSync);
+    void shmemx_double_max_inscan (double *target, double *source,
+                                   int nreduce, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   double *pWrk, long *pSync);
+    void shmemx_double_max_exscan (double *target, double *source,
+                                   int nreduce, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   double *pWrk, long *pSync);
+    void shmemx_int_min_inscan (int *target, int *source,
+                                int nreduce, int PE_start,
+                                int logPE_stride, int PE_size,
+                                int *pWrk, long *pSync);
+    void shmemx_int_min_exscan (int *target, int *source,
+                                int nreduce, int PE_start,
+                                int logPE_stride, int PE_size,
+                                int *pWrk, long *pSync);
+    void shmemx_long_min_inscan (long *target, long *source,
+                                 int nreduce, int PE_start,
+                                 int logPE_stride, int PE_size,
+                                 long *pWrk, long *pSync);
+    void shmemx_long_min_exscan (long *target, long *source,
+                                 int nreduce, int PE_start,
+                                 int logPE_stride, int PE_size,
+                                 long *pWrk, long *pSync);
+    void shmemx_longlong_min_inscan (long long *target, long long *source,
+                                     int nreduce, int PE_start,
+                                     int logPE_stride, int PE_size,
+                                     long long *pWrk, long *pSync);
+    void shmemx_longlong_min_exscan (long long *target, long long *source,
+                                     int nreduce, int PE_start,
+                                     int logPE_stride, int PE_size,
+                                     long long *pWrk, long *pSync);
+    void shmemx_float_min_inscan (float *target, float *source,
+                                  int nreduce, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  float *pWrk, long *pSync);
+    void shmemx_float_min_exscan (float *target, float *source,
+                                  int nreduce, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  float *pWrk, long *pSync);
+    void shmemx_double_min_inscan (double *target, double *source,
+                                   int nreduce, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   double *pWrk, long *pSync);
+    void shmemx_double_min_exscan (double *target, double *source,
+                                   int nreduce, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   double *pWrk, long *pSync);
+    void shmemx_int_prod_inscan (int *target, int *source,
+                                 int nreduce, int PE_start,
+                                 int logPE_stride, int PE_size,
+                                 int *pWrk, long *pSync);
+    void shmemx_int_prod_exscan (int *target, int *source,
+                                 int nreduce, int PE_start,
+                                 int logPE_stride, int PE_size,
+                                 int *pWrk, long *pSync);
+    void shmemx_long_prod_inscan (long *target, long *source,
+                                  int nreduce, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  long *pWrk, long *pSync);
+    void shmemx_long_prod_exscan (long *target, long *source,
+                                  int nreduce, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  long *pWrk, long *pSync);
+    void shmemx_longlong_prod_inscan (long long *target, long long *source,
+                                      int nreduce, int PE_start,
+                                      int logPE_stride, int PE_size,
+                                      long long *pWrk, long *pSync);
+    void shmemx_longlong_prod_exscan (long long *target, long long *source,
+                                      int nreduce, int PE_start,
+                                      int logPE_stride, int PE_size,
+                                      long long *pWrk, long *pSync);
+    void shmemx_float_prod_inscan (float *target, float *source,
+                                   int nreduce, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   float *pWrk, long *pSync);
+    void shmemx_float_prod_exscan (float *target, float *source,
+                                   int nreduce, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   float *pWrk, long *pSync);
+    void shmemx_double_prod_inscan (double *target, double *source,
+                                    int nreduce, int PE_start,
+                                    int logPE_stride, int PE_size,
+                                    double *pWrk, long *pSync);
+    void shmemx_double_prod_exscan (double *target, double *source,
+                                    int nreduce, int PE_start,
+                                    int logPE_stride, int PE_size,
+                                    double *pWrk, long *pSync);
+
+    /*
+     * rooted reductions
+     *
+     */
+
+    /**
+     * @brief sum reductions that leave the result on one PE
+     * (to_root), or spread it across the set (reduce_scatter)
+     *
+     * @section Synopsis:
+     *
+     * @substitute c C/C++
+     * @code
+     void shmemx_long_sum_to_root (long *target, long *source,
+                                   int nreduce, int PE_root, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   long *pWrk, long *pSync);
+     void shmemx_long_sum_reduce_scatter (long *target, long *source,
+                                          int nreduce, int PE_start,
+                                          int logPE_stride, int PE_size,
+                                          long *pWrk, long *pSync);
+     * @endcode
+     *
+     * Available for the same types as shmem_*_sum_to_all.  For
+     * to_root, PE_root is the index of the root in the set, and target
+     * on the other PEs is used as scratch.  For reduce_scatter, source
+     * holds PE_size blocks of nreduce elements, and the i'th PE of the
+     * set gets the sum of everyone's i'th block in target.  There
+     * target must not overlap source.  Otherwise arguments are as for
+     * the *_to_all reductions.
+     *
+     */
+    void shmemx_short_sum_to_root (short *target,
+                                   short *source, int nreduce,
+                                   int PE_root, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   short *pWrk, long *pSync);
+    void shmemx_int_sum_to_root (int *target,
+                                 int *source, int nreduce,
+                                 int PE_root, int PE_start,
+                                 int logPE_stride, int PE_size,
+                                 int *pWrk, long *pSync);
+    void shmemx_long_sum_to_root (long *target,
+                                  long *source, int nreduce,
+                                  int PE_root, int PE_start,
+                                  int logPE_stride, int PE_size,
+                                  long *pWrk, long *pSync);
+    void shmemx_longlong_sum_to_root (long long *target,
+                                      long long *source, int nreduce,
+                                      int PE_root, int PE_start,
+                                      int logPE_stride, int PE_size,
+                                      long long *pWrk, long *pSync);
+    void shmemx_double_sum_to_root (double *target,
+                                    double *source, int nreduce,
+                                    int PE_root, int PE_start,
+                                    int logPE_stride, int PE_size,
+                                    double *pWrk, long *pSync);
+    void shmemx_float_sum_to_root (float *target,
+                                   float *source, int nreduce,
+                                   int PE_root, int PE_start,
+                                   int logPE_stride, int PE_size,
+                                   float *pWrk, long *pSync);
+    void shmemx_longdouble_sum_to_root (long double *target,
+                                        long double *source, int nreduce,
+                                        int PE_root, int PE_start,
+                                        int logPE_stride, int PE_size,
+                                        long double *pWrk, long *pSync);
+    void shmemx_complexd_sum_to_root (COMPLEXIFY (double) * target,
+                                      COMPLEXIFY (double) * source, int nreduce,
+                                      int PE_root, int PE_start,
+                                      int logPE_stride, int PE_size,
+                                      COMPLEXIFY (double) * pWrk, long *pSync);
+    void shmemx_complexf_sum_to_root (COMPLEXIFY (float) * target,
+                                      COMPLEXIFY (float) * source, int nreduce,
+                                      int PE_root, int PE_start,
+                                      int logPE_stride, int PE_size,
+                                      COMPLEXIFY (float) * pWrk, long *pSync);
+    void shmemx_short_sum_reduce_scatter (short *target,
+                                          short *source, int nreduce,
+                                          int PE_start, int logPE_stride,
+                                          int PE_size, short *pWrk,
+                                          long *pSync);
+    void shmemx_int_sum_reduce_scatter (int *target,
+                                        int *source, int nreduce,
+                                        int PE_start, int logPE_stride,
+                                        int PE_size, int *pWrk,
+                                        long *pSync);
+    void shmemx_long_sum_reduce_scatter (long *target,
+                                         long *source, int nreduce,
+                                         int PE_start, int logPE_stride,
+                                         int PE_size, long *pWrk,
+                                         long *pSync);
+    void shmemx_longlong_sum_reduce_scatter (long long *target,
+                                             long long *source, int nreduce,
+                                             int PE_start, int logPE_stride,
+                                             int PE_size, long long *pWrk,
+                                             long *pSync);
+    void shmemx_double_sum_reduce_scatter (double *target,
+                                           double *source, int nreduce,
+                                           int PE_start, int logPE_stride,
+                                           int PE_size, double *pWrk,
+                                           long *pSync);
+    void shmemx_float_sum_reduce_scatter (float *target,
+                                          float *source, int nreduce,
+                                          int PE_start, int logPE_stride,
+                                          int PE_size, float *pWrk,
+                                          long *pSync);
+    void shmemx_longdouble_sum_reduce_scatter (long double *target,
+                                               long double *source, int nreduce,
+                                               int PE_start, int logPE_stride,
+                                               int PE_size, long double *pWrk,
+                                               long *pSync);
+    void shmemx_complexd_sum_reduce_scatter (COMPLEXIFY (double) * target,
+                                             COMPLEXIFY (double) * source, int nreduce,
+                                             int PE_start, int logPE_stride,
+                                             int PE_size, COMPLEXIFY (double) * pWrk,
+                                             long *pSync);
+    void shmemx_complexf_sum_reduce_scatter (COMPLEXIFY (float) * target,
+                                             COMPLEXIFY (float) * source, int nreduce,
+                                             int PE_start, int logPE_stride,
+                                             int PE_size, COMPLEXIFY (float) * pWrk,
+                                             long *pSync);
+
+    /**
+     * @brief reduce nreduce elements of elem_size bytes each with a
+     * user-supplied operator
+     *
+     * @section Synopsis:
+     *
+     * @substitute c C/C++
+     * @code
+     void shmemx_reduce_udr (void *target, const void *source,
+                             size_t nreduce, size_t elem_size,
+                             void (*op) (void *inout, const void *in,
+                                         size_t n),
+                             int PE_start, int logPE_stride, int PE_size,
+                             void *pWrk, long *pSync);
+     * @endcode
+     *
+     * op(inout, in, n) combines n elements of "in" into "inout",
+     * element by element, and must be associative.  PEs are combined
+     * in set order, so every PE gets the same result.  pWrk must hold
+     * at least SHMEM_REDUCE_MIN_WRKDATA_SIZE elements, and pSync is
+     * as for the *_to_all reductions.
+     *
+     */
+    void shmemx_reduce_udr (void *target, const void *source,
+                            size_t nreduce, size_t elem_size,
+                            void (*op) (void *inout, const void *in,
+                                        size_t n),
+                            int PE_start, int logPE_stride, int PE_size,
+                            void *pWrk, long *pSync);
+
+    /*
+     * untyped and variable-count collectives
+     *
+     */
+
+    /**
+     * @brief broadcast and fcollect with the size given in bytes
+     *
+     * @section Synopsis:
+     *
+     * @substitute c C/C++
+     * @code
+     void shmemx_broadcastmem (void *target, const void *source,
+                               size_t nbytes, int PE_root, int PE_start,
+                               int logPE_stride, int PE_size,
+                               long *pSync);
+     void shmemx_fcollectmem (void *target, const void *source,
+                              size_t nbytes, int PE_start,
+                              int logPE_stride, int PE_size, long *pSync);
+     * @endcode
+     *
+     * As shmem_broadcast32/64 and shmem_fcollect32/64, but nbytes
+     * need not be a multiple of the word size.  pSync must have
+     * SHMEM_BCAST_SYNC_SIZE and SHMEM_COLLECT_SYNC_SIZE elements
+     * respectively.
+     *
+     */
+    void shmemx_broadcastmem (void *target, const void *source,
+                              size_t nbytes, int PE_root, int PE_start,
+                              int logPE_stride, int PE_size, long *pSync);
+    void shmemx_fcollectmem (void *target, const void *source,
+                             size_t nbytes, int PE_start,
+                             int logPE_stride, int PE_size, long *pSync);
+
+    /**
+     * @brief all-to-all exchange of blocks of differing sizes
+     *
+     * @section Synopsis:
+     *
+     * @substitute c C/C++
+     * @code
+     void shmemx_alltoallv (void *target, size_t *target_counts,
+                            size_t *target_displs,
+                            const void *source,
+                            const size_t *source_counts,
+                            const size_t *source_displs,
+                            int PE_start, int logPE_stride, int PE_size,
+                            long *pSync);
+     * @endcode
+     *
+     * Each PE sends source_counts[i] bytes, starting source_displs[i]
+     * bytes into source, to the i'th PE of the set.  The counts are
+     * exchanged inside the call, so the receivers need not know them
+     * in advance: on return target_counts[i] and target_displs[i]
+     * give the size and position in target of the block from the
+     * i'th PE.  Blocks are packed into target in set order, so target
+     * must be big enough for everything this PE can receive.
+     *
+     * All arrays must be symmetric; the count and displacement
+     * arrays have PE_size elements.  pSync must have
+     * SHMEM_ALLTOALL_SYNC_SIZE elements.
+     *
+     */
+    void shmemx_alltoallv (void *target, size_t *target_counts,
+                           size_t *target_displs,
+                           const void *source,
+                           const size_t *source_counts,
+                           const size_t *source_displs,
+                           int PE_start, int logPE_stride, int PE_size,
+                           long *pSync);
+
+    /*
+     * collective tuning
+     *
+     */
+
+    /**
+     * @brief time each collective algorithm over a range of PE counts
+     * and message sizes, use the fastest for the rest of the run, and
+     * write them out as a tuning table
+     *
+     * @section Synopsis:
+     *
+     * @substitute c C/C++
+     * @code
+     void shmemx_collective_tune (const char *path);
+     * @endcode
+     *
+     * @param path file PE 0 writes the table to, or NULL to keep it
+     * in this run only.  Point SHMEM_TUNING_FILE at it in later runs.
+     *
+     * Must be called by all PEs.  It can take a while on large jobs.
+     *
+     */
+    void shmemx_collective_tune (const char *path);
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
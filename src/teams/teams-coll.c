@@ -0,0 +1,267 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#if defined(HAVE_FEATURE_EXPERIMENTAL)
+
+#include <stdio.h>
+
+#include "trace.h"
+#include "utils.h"
+
+#include "shmem.h"
+#include "shmemx.h"
+
+#include "teams.h"
+
+#ifdef HAVE_FEATURE_PSHMEM
+#include "pshmemx.h"
+#endif /* HAVE_FEATURE_PSHMEM */
+
+/*
+ * Collectives over teams: the team supplies the active set, the pSync
+ * (from its pool, so back-to-back calls don't need a barrier in
+ * between) and the reduction work array.  Roots are team ranks.
+ */
+
+#ifdef HAVE_FEATURE_PSHMEM
+#pragma weak shmemx_team_broadcast32 = pshmemx_team_broadcast32
+#define shmemx_team_broadcast32 pshmemx_team_broadcast32
+#pragma weak shmemx_team_fcollect32 = pshmemx_team_fcollect32
+#define shmemx_team_fcollect32 pshmemx_team_fcollect32
+#pragma weak shmemx_team_alltoall32 = pshmemx_team_alltoall32
+#define shmemx_team_alltoall32 pshmemx_team_alltoall32
+#pragma weak shmemx_team_broadcast64 = pshmemx_team_broadcast64
+#define shmemx_team_broadcast64 pshmemx_team_broadcast64
+#pragma weak shmemx_team_fcollect64 = pshmemx_team_fcollect64
+#define shmemx_team_fcollect64 pshmemx_team_fcollect64
+#pragma weak shmemx_team_alltoall64 = pshmemx_team_alltoall64
+#define shmemx_team_alltoall64 pshmemx_team_alltoall64
+#endif /* HAVE_FEATURE_PSHMEM */
+
+#define SHMEMX_TEAM_BROADCAST(Bits)                                     \
+    void                                                                \
+    shmemx_team_broadcast##Bits (shmemx_team_t team,                    \
+                                 void *target, const void *source,      \
+                                 size_t nelems, int PE_root)            \
+    {                                                                   \
+        DEBUG_NAME ("shmemx_team_broadcast" #Bits);                     \
+        INIT_CHECK (debug_name);                                        \
+        if (EXPR_UNLIKELY (team == SHMEMX_TEAM_INVALID)) {              \
+            return;                                                     \
+        }                                                               \
+        shmem_broadcast##Bits (target, source, nelems, PE_root,         \
+                               team->start, team->log_stride, team->size, \
+                               shmemi_team_psync (team));               \
+    }
+
+SHMEMX_TEAM_BROADCAST (32);
+SHMEMX_TEAM_BROADCAST (64);
+
+#define SHMEMX_TEAM_FCOLLECT(Bits)                                      \
+    void                                                                \
+    shmemx_team_fcollect##Bits (shmemx_team_t team,                     \
+                                void *target, const void *source,       \
+                                size_t nelems)                          \
+    {                                                                   \
+        DEBUG_NAME ("shmemx_team_fcollect" #Bits);                      \
+        INIT_CHECK (debug_name);                                        \
+        if (EXPR_UNLIKELY (team == SHMEMX_TEAM_INVALID)) {              \
+            return;                                                     \
+        }                                                               \
+        shmem_fcollect##Bits (target, source, nelems,                   \
+                              team->start, team->log_stride, team->size, \
+                              shmemi_team_psync (team));                \
+    }
+
+SHMEMX_TEAM_FCOLLECT (32);
+SHMEMX_TEAM_FCOLLECT (64);
+
+#define SHMEMX_TEAM_ALLTOALL(Bits)                                      \
+    void                                                                \
+    shmemx_team_alltoall##Bits (shmemx_team_t team,                     \
+                                void *target, const void *source,       \
+                                size_t nelems)                          \
+    {                                                                   \
+        DEBUG_NAME ("shmemx_team_alltoall" #Bits);                      \
+        INIT_CHECK (debug_name);                                        \
+        if (EXPR_UNLIKELY (team == SHMEMX_TEAM_INVALID)) {              \
+            return;                                                     \
+        }                                                               \
+        shmem_alltoall##Bits (target, source, nelems,                   \
+                              team->start, team->log_stride, team->size, \
+                              shmemi_team_psync (team));                \
+    }
+
+SHMEMX_TEAM_ALLTOALL (32);
+SHMEMX_TEAM_ALLTOALL (64);
+
+#ifdef HAVE_FEATURE_PSHMEM
+#pragma weak shmemx_team_int_sum_reduce = pshmemx_team_int_sum_reduce
+#define shmemx_team_int_sum_reduce pshmemx_team_int_sum_reduce
+#pragma weak shmemx_team_int_prod_reduce = pshmemx_team_int_prod_reduce
+#define shmemx_team_int_prod_reduce pshmemx_team_int_prod_reduce
+#pragma weak shmemx_team_int_min_reduce = pshmemx_team_int_min_reduce
+#define shmemx_team_int_min_reduce pshmemx_team_int_min_reduce
+#pragma weak shmemx_team_int_max_reduce = pshmemx_team_int_max_reduce
+#define shmemx_team_int_max_reduce pshmemx_team_int_max_reduce
+#pragma weak shmemx_team_long_sum_reduce = pshmemx_team_long_sum_reduce
+#define shmemx_team_long_sum_reduce pshmemx_team_long_sum_reduce
+#pragma weak shmemx_team_long_prod_reduce = pshmemx_team_long_prod_reduce
+#define shmemx_team_long_prod_reduce pshmemx_team_long_prod_reduce
+#pragma weak shmemx_team_long_min_reduce = pshmemx_team_long_min_reduce
+#define shmemx_team_long_min_reduce pshmemx_team_long_min_reduce
+#pragma weak shmemx_team_long_max_reduce = pshmemx_team_long_max_reduce
+#define shmemx_team_long_max_reduce pshmemx_team_long_max_reduce
+#pragma weak shmemx_team_longlong_sum_reduce = pshmemx_team_longlong_sum_reduce
+#define shmemx_team_longlong_sum_reduce pshmemx_team_longlong_sum_reduce
+#pragma weak shmemx_team_longlong_prod_reduce = pshmemx_team_longlong_prod_reduce
+#define shmemx_team_longlong_prod_reduce pshmemx_team_longlong_prod_reduce
+#pragma weak shmemx_team_longlong_min_reduce = pshmemx_team_longlong_min_reduce
+#define shmemx_team_longlong_min_reduce pshmemx_team_longlong_min_reduce
+#pragma weak shmemx_team_longlong_max_reduce = pshmemx_team_longlong_max_reduce
+#define shmemx_team_longlong_max_reduce pshmemx_team_longlong_max_reduce
+#pragma weak shmemx_team_float_sum_reduce = pshmemx_team_float_sum_reduce
+#define shmemx_team_float_sum_reduce pshmemx_team_float_sum_reduce
+#pragma weak shmemx_team_float_prod_reduce = pshmemx_team_float_prod_reduce
+#define shmemx_team_float_prod_reduce pshmemx_team_float_prod_reduce
+#pragma weak shmemx_team_float_min_reduce = pshmemx_team_float_min_reduce
+#define shmemx_team_float_min_reduce pshmemx_team_float_min_reduce
+#pragma weak shmemx_team_float_max_reduce = pshmemx_team_float_max_reduce
+#define shmemx_team_float_max_reduce pshmemx_team_float_max_reduce
+#pragma weak shmemx_team_double_sum_reduce = pshmemx_team_double_sum_reduce
+#define shmemx_team_double_sum_reduce pshmemx_team_double_sum_reduce
+#pragma weak shmemx_team_double_prod_reduce = pshmemx_team_double_prod_reduce
+#define shmemx_team_double_prod_reduce pshmemx_team_double_prod_reduce
+#pragma weak shmemx_team_double_min_reduce = pshmemx_team_double_min_reduce
+#define shmemx_team_double_min_reduce pshmemx_team_double_min_reduce
+#pragma weak shmemx_team_double_max_reduce = pshmemx_team_double_max_reduce
+#define shmemx_team_double_max_reduce pshmemx_team_double_max_reduce
+#pragma weak shmemx_team_int_and_reduce = pshmemx_team_int_and_reduce
+#define shmemx_team_int_and_reduce pshmemx_team_int_and_reduce
+#pragma weak shmemx_team_int_or_reduce = pshmemx_team_int_or_reduce
+#define shmemx_team_int_or_reduce pshmemx_team_int_or_reduce
+#pragma weak shmemx_team_int_xor_reduce = pshmemx_team_int_xor_reduce
+#define shmemx_team_int_xor_reduce pshmemx_team_int_xor_reduce
+#pragma weak shmemx_team_long_and_reduce = pshmemx_team_long_and_reduce
+#define shmemx_team_long_and_reduce pshmemx_team_long_and_reduce
+#pragma weak shmemx_team_long_or_reduce = pshmemx_team_long_or_reduce
+#define shmemx_team_long_or_reduce pshmemx_team_long_or_reduce
+#pragma weak shmemx_team_long_xor_reduce = pshmemx_team_long_xor_reduce
+#define shmemx_team_long_xor_reduce pshmemx_team_long_xor_reduce
+#pragma weak shmemx_team_longlong_and_reduce = pshmemx_team_longlong_and_reduce
+#define shmemx_team_longlong_and_reduce pshmemx_team_longlong_and_reduce
+#pragma weak shmemx_team_longlong_or_reduce = pshmemx_team_longlong_or_reduce
+#define shmemx_team_longlong_or_reduce pshmemx_team_longlong_or_reduce
+#pragma weak shmemx_team_longlong_xor_reduce = pshmemx_team_longlong_xor_reduce
+#define shmemx_team_longlong_xor_reduce pshmemx_team_longlong_xor_reduce
+#endif /* HAVE_FEATURE_PSHMEM */
+
+/*
+ * the reductions only ever use SHMEM_REDUCE_MIN_WRKDATA_SIZE elements
+ * of pWrk, whatever nreduce is, so the team's work array is enough
+ */
+
+#define SHMEMX_TEAM_REDUCE(Name, Type, Op)                              \
+    void                                                                \
+    shmemx_team_##Name##_##Op##_reduce (shmemx_team_t team,             \
+                                        Type *target, const Type *source, \
+                                        int nreduce)                    \
+    {                                                                   \
+        DEBUG_NAME ("shmemx_team_" #Name "_" #Op "_reduce");            \
+        INIT_CHECK (debug_name);                                        \
+        if (EXPR_UNLIKELY (team == SHMEMX_TEAM_INVALID)) {              \
+            return;                                                     \
+        }                                                               \
+        shmem_##Name##_##Op##_to_all (target, (Type *) source, nreduce, \
+                                      team->start, team->log_stride,    \
+                                      team->size,                       \
+                                      (Type *) shmemi_team_pwrk (team), \
+                                      shmemi_team_psync (team));        \
+    }
+
+SHMEMX_TEAM_REDUCE (int, int, sum);
+SHMEMX_TEAM_REDUCE (long, long, sum);
+SHMEMX_TEAM_REDUCE (longlong, long long, sum);
+SHMEMX_TEAM_REDUCE (float, float, sum);
+SHMEMX_TEAM_REDUCE (double, double, sum);
+
+SHMEMX_TEAM_REDUCE (int, int, prod);
+SHMEMX_TEAM_REDUCE (long, long, prod);
+SHMEMX_TEAM_REDUCE (longlong, long long, prod);
+SHMEMX_TEAM_REDUCE (float, float, prod);
+SHMEMX_TEAM_REDUCE (double, double, prod);
+
+SHMEMX_TEAM_REDUCE (int, int, min);
+SHMEMX_TEAM_REDUCE (long, long, min);
+SHMEMX_TEAM_REDUCE (longlong, long long, min);
+SHMEMX_TEAM_REDUCE (float, float, min);
+SHMEMX_TEAM_REDUCE (double, double, min);
+
+SHMEMX_TEAM_REDUCE (int, int, max);
+SHMEMX_TEAM_REDUCE (long, long, max);
+SHMEMX_TEAM_REDUCE (longlong, long long, max);
+SHMEMX_TEAM_REDUCE (float, float, max);
+SHMEMX_TEAM_REDUCE (double, double, max);
+
+SHMEMX_TEAM_REDUCE (int, int, and);
+SHMEMX_TEAM_REDUCE (long, long, and);
+SHMEMX_TEAM_REDUCE (longlong, long long, and);
+
+SHMEMX_TEAM_REDUCE (int, int, or);
+SHMEMX_TEAM_REDUCE (long, long, or);
+SHMEMX_TEAM_REDUCE (longlong, long long, or);
+
+SHMEMX_TEAM_REDUCE (int, int, xor);
+SHMEMX_TEAM_REDUCE (long, long, xor);
+SHMEMX_TEAM_REDUCE (longlong, long long, xor);
+
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
@@ -0,0 +1,512 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#if defined(HAVE_FEATURE_EXPERIMENTAL)
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "state.h"
+#include "trace.h"
+#include "utils.h"
+#include "memalloc.h"
+
+#include "shmem.h"
+#include "shmemx.h"
+
+#include "teams.h"
+
+#ifdef HAVE_FEATURE_PSHMEM
+#include "pshmemx.h"
+#endif /* HAVE_FEATURE_PSHMEM */
+
+/*
+ * the team of all PEs, filled in at start-up
+ */
+static struct shmemi_team world_team;
+
+shmemx_team_t shmemx_team_world = &world_team;
+
+/*
+ * symmetric sync areas, one per slot
+ */
+static team_sync_t *team_sync = NULL;
+
+/*
+ * bit set => slot not used by any team this PE belongs to
+ */
+static unsigned long free_slots = ~0UL;
+
+/**
+ * stride as a power of 2, or -1 if it isn't one
+ */
+static inline int
+stride_to_log (int stride)
+{
+    int l = 0;
+
+    if ( (stride <= 0) || ((stride & (stride - 1)) != 0) ) {
+        return -1;
+    }
+    while ((1 << l) < stride) {
+        l += 1;
+    }
+    return l;
+}
+
+static inline int
+in_set (int pe, int start, int log_stride, int size)
+{
+    const int off = pe - start;
+
+    return
+        (off >= 0) &&
+        ((off & ((1 << log_stride) - 1)) == 0) &&
+        ((off >> log_stride) < size);
+}
+
+static void
+team_init_sync (team_sync_t *s)
+{
+    int i, j;
+
+    for (i = 0; i < TEAM_PSYNC_POOL; i += 1) {
+        for (j = 0; j < SHMEM_REDUCE_SYNC_SIZE; j += 1) {
+            s->psync[i][j] = SHMEM_SYNC_VALUE;
+        }
+    }
+    for (j = 0; j < SHMEM_BARRIER_SYNC_SIZE; j += 1) {
+        s->barrier_psync[j] = SHMEM_SYNC_VALUE;
+    }
+}
+
+/**
+ * make the sync areas for all slots.  Until the first team needs
+ * them the only team is the world, so this is collective over all
+ * PEs and the allocation stays symmetric.
+ */
+static void
+teams_sync_alloc (void)
+{
+    const size_t n = TEAM_MAX_SLOTS * sizeof (*team_sync);
+    int i;
+
+    team_sync = (team_sync_t *) shmemi_mem_alloc (n);
+    if (EXPR_UNLIKELY (team_sync == (team_sync_t *) NULL)) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "internal error: unable to allocate %lu bytes"
+                      " of symmetric memory for teams",
+                      (unsigned long) n);
+        return;
+        /* NOT REACHED */
+    }
+
+    for (i = 0; i < TEAM_MAX_SLOTS; i += 1) {
+        team_init_sync (&(team_sync[i]));
+    }
+
+    shmemi_trace (SHMEM_LOG_INFO,
+                  "team sync areas use %lu bytes of symmetric heap",
+                  (unsigned long) n);
+
+    /* no-one may write to my sync areas before they are initialized */
+    shmem_barrier_all ();
+}
+
+/**
+ * team's sync area, made on first use
+ */
+static inline team_sync_t *
+team_sync_of (shmemx_team_t t)
+{
+    if (EXPR_UNLIKELY (team_sync == (team_sync_t *) NULL)) {
+        teams_sync_alloc ();
+    }
+    return &(team_sync[t->slot]);
+}
+
+static void
+team_fill (shmemx_team_t t, int start, int log_stride, int size, int slot)
+{
+    t->start = start;
+    t->log_stride = log_stride;
+    t->stride = 1 << log_stride;
+    t->size = size;
+    t->mype = (GET_STATE (mype) - start) >> log_stride;
+    t->slot = slot;
+    t->next = 0;
+
+    free_slots &= ~(1UL << slot);
+}
+
+static shmemx_team_t
+team_create (int start, int log_stride, int size, int slot)
+{
+    shmemx_team_t t = (shmemx_team_t) malloc (sizeof (*t));
+
+    if (EXPR_UNLIKELY (t == SHMEMX_TEAM_INVALID)) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "internal error: unable to allocate team");
+        return SHMEMX_TEAM_INVALID;
+        /* NOT REACHED */
+    }
+
+    team_fill (t, start, log_stride, size, slot);
+
+    shmemi_trace (SHMEM_LOG_INFO,
+                  "joined team start = %d, stride = %d, size = %d"
+                  " as rank %d (slot %d)",
+                  t->start, t->stride, t->size, t->mype, t->slot);
+
+    return t;
+}
+
+/**
+ * agree with the rest of the parent on slots that are free on all of
+ * its PEs.  Every PE in the parent gets the same answer.
+ */
+static int
+team_pick_slots (shmemx_team_t parent, int nslots, int *slots)
+{
+    team_sync_t *s = team_sync_of (parent);
+    unsigned long avail;
+    int found = 0;
+    int i;
+
+    s->scratch[0] = (long) free_slots;
+    shmem_long_and_to_all (&(s->scratch[1]), &(s->scratch[0]), 1,
+                           parent->start, parent->log_stride, parent->size,
+                           (long *) s->pwrk, shmemi_team_psync (parent));
+    avail = (unsigned long) s->scratch[1];
+
+    for (i = 0; (i < TEAM_MAX_SLOTS) && (found < nslots); i += 1) {
+        if (avail & (1UL << i)) {
+            slots[found] = i;
+            found += 1;
+        }
+    }
+
+    return (found == nslots) ? 0 : -1;
+}
+
+/**
+ * hand out the next sync array from the team's pool.  Once the whole
+ * pool has been used, everyone has to be done with it before it can
+ * go round again.
+ */
+long *
+shmemi_team_psync (shmemx_team_t t)
+{
+    team_sync_t *s = team_sync_of (t);
+
+    if (EXPR_UNLIKELY (t->next == TEAM_PSYNC_POOL)) {
+        shmem_barrier (t->start, t->log_stride, t->size,
+                       s->barrier_psync);
+        t->next = 0;
+    }
+
+    return s->psync[t->next++];
+}
+
+/**
+ * the team's reduction work area
+ */
+void *
+shmemi_team_pwrk (shmemx_team_t t)
+{
+    return team_sync_of (t)->pwrk;
+}
+
+/**
+ * set up the world team.  The symmetric sync areas wait until a team
+ * first needs them, so programs without teams don't pay for them.
+ */
+void
+shmemi_teams_init (void)
+{
+    team_fill (&world_team, 0, 0, GET_STATE (numpes), 0);
+}
+
+#ifdef HAVE_FEATURE_PSHMEM
+#pragma weak shmemx_team_my_pe = pshmemx_team_my_pe
+#define shmemx_team_my_pe pshmemx_team_my_pe
+#pragma weak shmemx_team_n_pes = pshmemx_team_n_pes
+#define shmemx_team_n_pes pshmemx_team_n_pes
+#pragma weak shmemx_team_translate_pe = pshmemx_team_translate_pe
+#define shmemx_team_translate_pe pshmemx_team_translate_pe
+#pragma weak shmemx_team_split_strided = pshmemx_team_split_strided
+#define shmemx_team_split_strided pshmemx_team_split_strided
+#pragma weak shmemx_team_split_2d = pshmemx_team_split_2d
+#define shmemx_team_split_2d pshmemx_team_split_2d
+#pragma weak shmemx_team_destroy = pshmemx_team_destroy
+#define shmemx_team_destroy pshmemx_team_destroy
+#pragma weak shmemx_team_barrier = pshmemx_team_barrier
+#define shmemx_team_barrier pshmemx_team_barrier
+#endif /* HAVE_FEATURE_PSHMEM */
+
+int
+shmemx_team_my_pe (shmemx_team_t team)
+{
+    DEBUG_NAME ("shmemx_team_my_pe");
+    INIT_CHECK (debug_name);
+
+    if (EXPR_UNLIKELY (team == SHMEMX_TEAM_INVALID)) {
+        return -1;
+    }
+    return team->mype;
+}
+
+int
+shmemx_team_n_pes (shmemx_team_t team)
+{
+    DEBUG_NAME ("shmemx_team_n_pes");
+    INIT_CHECK (debug_name);
+
+    if (EXPR_UNLIKELY (team == SHMEMX_TEAM_INVALID)) {
+        return -1;
+    }
+    return team->size;
+}
+
+int
+shmemx_team_translate_pe (shmemx_team_t src_team, int src_pe,
+                          shmemx_team_t dest_team)
+{
+    DEBUG_NAME ("shmemx_team_translate_pe");
+    int pe;
+
+    INIT_CHECK (debug_name);
+
+    if ( (src_team == SHMEMX_TEAM_INVALID) ||
+         (dest_team == SHMEMX_TEAM_INVALID) ||
+         (src_pe < 0) || (src_pe >= src_team->size) ) {
+        return -1;
+    }
+
+    pe = src_team->start + src_pe * src_team->stride;
+
+    if (! in_set (pe, dest_team->start, dest_team->log_stride,
+                  dest_team->size)) {
+        return -1;
+    }
+    return (pe - dest_team->start) >> dest_team->log_stride;
+}
+
+/**
+ * collective over parent.  PEs not in the new team get
+ * SHMEMX_TEAM_INVALID back.  The new team has to be a strided set of
+ * world PEs whose stride is a power of 2.
+ */
+int
+shmemx_team_split_strided (shmemx_team_t parent,
+                           int start, int stride, int size,
+                           shmemx_team_t *newteam)
+{
+    DEBUG_NAME ("shmemx_team_split_strided");
+    int world_start;
+    int log_stride;
+    int slot;
+
+    INIT_CHECK (debug_name);
+
+    *newteam = SHMEMX_TEAM_INVALID;
+
+    if (EXPR_UNLIKELY (parent == SHMEMX_TEAM_INVALID)) {
+        return -1;
+    }
+
+    if (size == 1) {
+        stride = 1;
+    }
+
+    if ( (size < 1) || (start < 0) || (stride < 1) ||
+         (start + (size - 1) * stride >= parent->size) ) {
+        shmemi_trace (SHMEM_LOG_NOTICE,
+                      "team split: start = %d, stride = %d, size = %d"
+                      " does not fit in parent team of %d PEs",
+                      start, stride, size, parent->size);
+        return -1;
+    }
+
+    world_start = parent->start + start * parent->stride;
+    log_stride = stride_to_log (stride * parent->stride);
+    if (EXPR_UNLIKELY (log_stride < 0)) {
+        shmemi_trace (SHMEM_LOG_NOTICE,
+                      "team split: stride %d in world PEs is not a power of 2",
+                      stride * parent->stride);
+        return -1;
+    }
+
+    if (EXPR_UNLIKELY (team_pick_slots (parent, 1, &slot) != 0)) {
+        shmemi_trace (SHMEM_LOG_NOTICE,
+                      "team split: no free team slots (maximum is %d)",
+                      (int) TEAM_MAX_SLOTS);
+        return -1;
+    }
+
+    if (in_set (GET_STATE (mype), world_start, log_stride, size)) {
+        *newteam = team_create (world_start, log_stride, size, slot);
+    }
+
+    return 0;
+}
+
+/**
+ * collective over parent: treat parent as rows of xrange PEs, every
+ * PE ends up in one row (xaxis) and one column (yaxis) team
+ */
+int
+shmemx_team_split_2d (shmemx_team_t parent, int xrange,
+                      shmemx_team_t *xaxis, shmemx_team_t *yaxis)
+{
+    DEBUG_NAME ("shmemx_team_split_2d");
+    int nrows;
+    int row, col;
+    int ylog;
+    int slots[2];
+
+    INIT_CHECK (debug_name);
+
+    *xaxis = SHMEMX_TEAM_INVALID;
+    *yaxis = SHMEMX_TEAM_INVALID;
+
+    if (EXPR_UNLIKELY (parent == SHMEMX_TEAM_INVALID)) {
+        return -1;
+    }
+    if (EXPR_UNLIKELY (xrange < 1)) {
+        shmemi_trace (SHMEM_LOG_NOTICE,
+                      "team split: xrange must be positive, got %d",
+                      xrange);
+        return -1;
+    }
+    if (xrange > parent->size) {
+        xrange = parent->size;
+    }
+
+    nrows = (parent->size + xrange - 1) / xrange;
+
+    /* columns are only a strided set if the stride is a power of 2 */
+    ylog = (nrows > 1) ? stride_to_log (xrange * parent->stride) : 0;
+    if (EXPR_UNLIKELY (ylog < 0)) {
+        shmemi_trace (SHMEM_LOG_NOTICE,
+                      "team split: column stride %d in world PEs"
+                      " is not a power of 2",
+                      xrange * parent->stride);
+        return -1;
+    }
+
+    if (EXPR_UNLIKELY (team_pick_slots (parent, 2, slots) != 0)) {
+        shmemi_trace (SHMEM_LOG_NOTICE,
+                      "team split: no free team slots (maximum is %d)",
+                      (int) TEAM_MAX_SLOTS);
+        return -1;
+    }
+
+    row = parent->mype / xrange;
+    col = parent->mype % xrange;
+
+    {
+        const int rsize =
+            (row < nrows - 1) ? xrange : parent->size - row * xrange;
+        const int csize =
+            (parent->size - col + xrange - 1) / xrange;
+
+        *xaxis = team_create (parent->start + row * xrange * parent->stride,
+                              parent->log_stride, rsize, slots[0]);
+        *yaxis = team_create (parent->start + col * parent->stride,
+                              ylog, csize, slots[1]);
+    }
+
+    return 0;
+}
+
+/**
+ * collective over the team
+ */
+void
+shmemx_team_destroy (shmemx_team_t team)
+{
+    DEBUG_NAME ("shmemx_team_destroy");
+    INIT_CHECK (debug_name);
+
+    if (EXPR_UNLIKELY (team == SHMEMX_TEAM_INVALID)) {
+        return;
+    }
+    if (EXPR_UNLIKELY (team == SHMEMX_TEAM_WORLD)) {
+        shmemi_trace (SHMEM_LOG_NOTICE,
+                      "cannot destroy the world team");
+        return;
+    }
+
+    /* nobody is still using the slot once we're all here */
+    shmem_barrier (team->start, team->log_stride, team->size,
+                   team_sync_of (team)->barrier_psync);
+
+    free_slots |= (1UL << team->slot);
+    free (team);
+}
+
+void
+shmemx_team_barrier (shmemx_team_t team)
+{
+    DEBUG_NAME ("shmemx_team_barrier");
+    INIT_CHECK (debug_name);
+
+    if (EXPR_UNLIKELY (team == SHMEMX_TEAM_INVALID)) {
+        return;
+    }
+
+    shmem_barrier (team->start, team->log_stride, team->size,
+                   team_sync_of (team)->barrier_psync);
+}
+
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
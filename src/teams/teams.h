@@ -0,0 +1,105 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef _TEAMS_H
+#define _TEAMS_H 1
+
+#include "shmem.h"
+#include "shmemx.h"
+
+/*
+ * how many teams a PE can be a member of at once (one bit each in
+ * the free-slot mask)
+ */
+#define TEAM_MAX_SLOTS   (8 * sizeof (unsigned long))
+
+/*
+ * how many collectives a team can run back-to-back before it has to
+ * synchronize to recycle its sync arrays
+ */
+#define TEAM_PSYNC_POOL  4
+
+/**
+ * per-team symmetric sync and work areas.  These live in one
+ * symmetric array indexed by slot, so that a subset of PEs can make a
+ * team without anyone allocating symmetric memory.  The array is made
+ * when the first team needs it.
+ */
+typedef struct
+{
+    long psync[TEAM_PSYNC_POOL][SHMEM_REDUCE_SYNC_SIZE];
+    long barrier_psync[SHMEM_BARRIER_SYNC_SIZE];
+    long double pwrk[SHMEM_REDUCE_MIN_WRKDATA_SIZE];
+    long scratch[2];            /* symmetric source/target for set-up */
+} team_sync_t;
+
+/**
+ * a team is a strided subset of the world PEs, so it maps straight
+ * onto the (PE_start, logPE_stride, PE_size) triplet
+ */
+struct shmemi_team
+{
+    int start;                  /* world PE of team PE 0 */
+    int log_stride;             /* log2 of world stride */
+    int stride;                 /* world stride */
+    int size;                   /* # PEs in team */
+    int mype;                   /* my rank in team */
+    int slot;                   /* which sync area we own */
+    int next;                   /* next pSync to hand out */
+};
+
+extern void shmemi_teams_init (void);
+
+extern long *shmemi_team_psync (shmemx_team_t t);
+extern void *shmemi_team_pwrk (shmemx_team_t t);
+
+#endif /* _TEAMS_H */
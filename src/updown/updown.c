@@ -64,9 +64,12 @@
 
 #ifdef HAVE_FEATURE_EXPERIMENTAL
 #include "pshmemx.h"
+#include "teams.h"
+#include "nbcoll.h"
 #endif /* HAVE_FEATURE_EXPERIMENTAL */
 
 #include "version.h"
+#include "tune.h"
 
 /* ----------------------------------------------------------------- */
 
@@ -130,6 +133,12 @@ shmem_init_private (int npes)
     }
 
     shmemi_comms_init ();
+    shmemi_tune_init ();
+
+#ifdef HAVE_FEATURE_EXPERIMENTAL
+    shmemi_teams_init ();
+    shmemi_nbcoll_init ();
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
 
     /* just note start_pes() not passed 0, it's not a big deal */
     if (npes != 0) {
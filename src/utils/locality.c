@@ -0,0 +1,380 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "state.h"
+#include "trace.h"
+#include "utils.h"
+#include "atomic.h"
+
+#include "comms/comms.h"
+
+#include "shmem.h"
+
+#include "locality.h"
+#include "schedule.h"
+
+/**
+ * can the two-level algorithms be used at all?
+ */
+static int available = 0;
+
+/**
+ * host -> leader index scratch table, -1 when not seen.  Hosts are
+ * numbered like PEs, so this has one entry per PE.
+ */
+static int *host_slot = NULL;
+
+/**
+ * look at the 'hood table once: two-level algorithms only pay off if
+ * some host runs more than one PE, and only work if all PEs on a host
+ * share memory
+ */
+void
+shmemi_locality_init (void)
+{
+    const int n = GET_STATE (numpes);
+    const int *where = GET_STATE (locp);
+    int crowded = 0;
+    int i;
+
+    for (i = 0; i < n; i += 1) {
+        if (where[i] < 0 || where[i] >= n) {
+            shmemi_trace (SHMEM_LOG_INIT,
+                          "PE %d has unexpected host number %d,"
+                          " not using locality",
+                          i, where[i]);
+            return;
+        }
+    }
+
+    host_slot = (int *) malloc (n * sizeof (*host_slot));
+    if (EXPR_UNLIKELY (host_slot == (int *) NULL)) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "internal error: cannot allocate memory for"
+                      " locality table");
+        return;
+        /* NOT REACHED */
+    }
+    for (i = 0; i < n; i += 1) {
+        host_slot[i] = -1;
+    }
+
+    /* compare each PE with the first one seen on its host */
+    for (i = 0; i < n; i += 1) {
+        const int first = host_slot[where[i]];
+
+        if (first < 0) {
+            host_slot[where[i]] = i;
+            continue;
+        }
+        crowded = 1;
+        if (! shmemi_comms_shared_memory (first, i)) {
+            shmemi_trace (SHMEM_LOG_INIT,
+                          "PEs %d and %d share a host but not memory,"
+                          " not using locality",
+                          first, i);
+            crowded = 0;
+            break;
+        }
+    }
+    for (i = 0; i < n; i += 1) {
+        host_slot[i] = -1;
+    }
+
+    if (! crowded) {
+        free (host_slot);
+        host_slot = NULL;
+        return;
+    }
+
+    available = 1;
+
+    shmemi_trace (SHMEM_LOG_INIT,
+                  "PEs share memory on-node, two-level collectives"
+                  " available");
+}
+
+int
+shmemi_locality_available (void)
+{
+    return available;
+}
+
+/**
+ * can a two-level algorithm use pSync on this set at all?
+ */
+static inline int
+usable (int PE_size, long *pSync)
+{
+    if (! available || PE_size < 2) {
+        return 0;
+    }
+    /* on-node sync goes straight through pSync */
+    return shmemi_comms_local_ptr (pSync, GET_STATE (mype)) != NULL;
+}
+
+/**
+ * work out hosts and leaders of a set
+ */
+static int
+layout (int PE_start, int logPE_stride, int PE_size, int root,
+        shmemi_locality_t *lp)
+{
+    const int me = GET_STATE (mype);
+    const int *where = GET_STATE (locp);
+    const int step = 1 << logPE_stride;
+    int i, k;
+
+    lp->leaders = (int *) malloc (2 * PE_size * sizeof (int));
+    if (EXPR_UNLIKELY (lp->leaders == (int *) NULL)) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "internal error: cannot allocate memory for"
+                      " locality table");
+        return 0;
+        /* NOT REACHED */
+    }
+    lp->locals = lp->leaders + PE_size;
+    lp->nnodes = 0;
+    lp->nlocal = 0;
+    lp->lrank = -1;
+
+    /*
+     * walk the set from the root, so the root leads its host and its
+     * host comes first
+     */
+    for (k = 0, i = root; k < PE_size; k += 1) {
+        const int pe = PE_start + i * step;
+        const int h = where[pe];
+
+        if (host_slot[h] < 0) {
+            host_slot[h] = lp->nnodes;
+            lp->leaders[lp->nnodes] = pe;
+            lp->nnodes += 1;
+        }
+        if (h == where[me]) {
+            if (pe == me) {
+                lp->lrank = lp->nlocal;
+            }
+            lp->locals[lp->nlocal] = pe;
+            lp->nlocal += 1;
+        }
+
+        i += 1;
+        if (i == PE_size) {
+            i = 0;
+        }
+    }
+
+    lp->node = host_slot[where[me]];
+
+    /* leave scratch table clean */
+    for (k = 0; k < lp->nnodes; k += 1) {
+        host_slot[where[lp->leaders[k]]] = -1;
+    }
+
+    /* nothing gained if every host has just 1 PE */
+    if (lp->nnodes == PE_size || lp->nnodes > (1 << LOCALITY_MAX_ROUNDS)) {
+        shmemi_locality_free (lp);
+        return 0;
+    }
+
+    return 1;
+}
+
+int
+shmemi_locality_build (int PE_start, int logPE_stride, int PE_size,
+                       int root, long *pSync, shmemi_locality_t *lp)
+{
+    if (! usable (PE_size, pSync)) {
+        return 0;
+    }
+    return layout (PE_start, logPE_stride, PE_size, root, lp);
+}
+
+static void
+destroy_cached (void *sched)
+{
+    shmemi_locality_t *lp = (shmemi_locality_t *) sched;
+
+    shmemi_locality_free (lp);
+    free (lp);
+}
+
+static void *
+build_cached (int PE_start, int logPE_stride, int PE_size, int root)
+{
+    shmemi_locality_t *lp = (shmemi_locality_t *) malloc (sizeof (*lp));
+
+    if (EXPR_UNLIKELY (lp == (shmemi_locality_t *) NULL)) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "internal error: cannot allocate memory for"
+                      " locality table");
+        return NULL;
+        /* NOT REACHED */
+    }
+    if (! layout (PE_start, logPE_stride, PE_size, root, lp)) {
+        free (lp);
+        return NULL;
+    }
+    return lp;
+}
+
+shmemi_locality_t *
+shmemi_locality_lookup (int PE_start, int logPE_stride, int PE_size,
+                        int root, long *pSync)
+{
+    if (! usable (PE_size, pSync)) {
+        return NULL;
+    }
+    return shmemi_schedule_lookup (SCHEDULE_LOCALITY,
+                                   PE_start, logPE_stride, PE_size, root,
+                                   build_cached, destroy_cached);
+}
+
+void
+shmemi_locality_free (shmemi_locality_t *lp)
+{
+    free (lp->leaders);
+    lp->leaders = lp->locals = NULL;
+}
+
+void *
+shmemi_locality_ptr (shmemi_locality_t *lp, const void *addr, int i)
+{
+    return shmemi_comms_local_ptr ((void *) addr, lp->locals[i]);
+}
+
+/**
+ * PEs flag their own ARRIVE slot; the leader reads and clears it
+ * through the mapping.  Since gather and release alternate, nobody
+ * flags again until the leader has let them go, so there is no lost
+ * update.
+ */
+void
+shmemi_locality_gather (shmemi_locality_t *lp, long *pSync)
+{
+    if (lp->lrank == 0) {
+        int i;
+
+        for (i = 1; i < lp->nlocal; i += 1) {
+            long *arrive =
+                shmemi_locality_ptr (lp, &pSync[LOCALITY_ARRIVE_SLOT], i);
+
+            shmem_long_wait_until (arrive, SHMEM_CMP_NE, SHMEM_SYNC_VALUE);
+            *arrive = SHMEM_SYNC_VALUE;
+        }
+        LOAD_STORE_FENCE ();
+    }
+    else {
+        LOAD_STORE_FENCE ();
+        *((volatile long *) &pSync[LOCALITY_ARRIVE_SLOT]) =
+            SHMEM_SYNC_VALUE + 1;
+    }
+}
+
+void
+shmemi_locality_release (shmemi_locality_t *lp, long *pSync)
+{
+    if (lp->lrank == 0) {
+        int i;
+
+        LOAD_STORE_FENCE ();
+        for (i = 1; i < lp->nlocal; i += 1) {
+            long *release =
+                shmemi_locality_ptr (lp, &pSync[LOCALITY_RELEASE_SLOT], i);
+
+            *((volatile long *) release) = SHMEM_SYNC_VALUE + 1;
+        }
+    }
+    else {
+        shmem_long_wait_until (&pSync[LOCALITY_RELEASE_SLOT],
+                               SHMEM_CMP_NE, SHMEM_SYNC_VALUE);
+        pSync[LOCALITY_RELEASE_SLOT] = SHMEM_SYNC_VALUE;
+        LOAD_STORE_FENCE ();
+    }
+}
+
+/**
+ * dissemination barrier over the leaders, one slot per round.  Each
+ * slot is cleared by its owner straight after it fires.
+ */
+static void
+dissemination (shmemi_locality_t *lp, long *slots)
+{
+    int dist, r;
+
+    for (r = 0, dist = 1; dist < lp->nnodes; r += 1, dist <<= 1) {
+        const int to = lp->leaders[(lp->node + dist) % lp->nnodes];
+
+        shmem_long_p (&slots[r], SHMEM_SYNC_VALUE + 1, to);
+        shmem_long_wait_until (&slots[r], SHMEM_CMP_NE, SHMEM_SYNC_VALUE);
+        slots[r] = SHMEM_SYNC_VALUE;
+    }
+}
+
+/**
+ * 2 back-to-back disseminations on different slots: once any leader
+ * is out of the 2nd, all have cleared their slots in the 1st, and so
+ * the same pSync can be used again straight away.
+ */
+void
+shmemi_locality_leader_barrier (shmemi_locality_t *lp, long *pSync)
+{
+    dissemination (lp, &pSync[LOCALITY_FIRST_ROUND]);
+    dissemination (lp, &pSync[LOCALITY_FIRST_ROUND + LOCALITY_MAX_ROUNDS]);
+
+    shmemi_trace (SHMEM_LOG_BARRIER,
+                  "leader barrier done across %d hosts", lp->nnodes);
+}
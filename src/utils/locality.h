@@ -0,0 +1,152 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef _LOCALITY_H
+#define _LOCALITY_H 1
+
+#include "shmem.h"
+
+/*
+ * two-level view of an active set: one leader per host does the
+ * inter-node part of a collective, the other PEs on that host only
+ * talk to their leader through shared memory
+ *
+ */
+
+typedef struct
+{
+    int nnodes;                 /* # of hosts the set spans */
+    int node;                   /* index of my host in leaders[] */
+    int *leaders;               /* leading PE on each host */
+
+    int nlocal;                 /* # of PEs in the set on my host */
+    int lrank;                  /* my index in locals[], 0 = leader */
+    int *locals;                /* PEs in the set on my host */
+} shmemi_locality_t;
+
+/*
+ * pSync slots used by the two-level algorithms.  The leader barrier
+ * takes 2 blocks of rounds, so that all fits in the smallest pSync.
+ *
+ * The last slot is left alone: the linear collect keeps its running
+ * offset there across its closing barrier.  Anything else that keeps
+ * values in slots 2 and up must not call shmem_barrier () on the same
+ * pSync while other PEs may still be using them (use
+ * shmemi_barrier_linear (), which only takes slots 0 and 1).
+ *
+ */
+
+#define LOCALITY_ARRIVE_SLOT    0
+#define LOCALITY_RELEASE_SLOT   1
+#define LOCALITY_DATA_SLOT      2
+#define LOCALITY_FIRST_ROUND    3
+#define LOCALITY_MAX_ROUNDS \
+    ((SHMEM_BARRIER_SYNC_SIZE - LOCALITY_FIRST_ROUND - 1) / 2)
+
+/*
+ * start the locality subsystem
+ *
+ */
+extern void shmemi_locality_init (void);
+
+/*
+ * true if some host runs more than 1 PE, and they share memory
+ *
+ */
+extern int shmemi_locality_available (void);
+
+/*
+ * build/release the two-level view of an active set.  Returns
+ * non-zero if a two-level algorithm can be used, in which case the
+ * PE at index "root" of the set leads its host
+ *
+ */
+extern int shmemi_locality_build (int PE_start, int logPE_stride,
+                                  int PE_size, int root, long *pSync,
+                                  shmemi_locality_t *lp);
+extern void shmemi_locality_free (shmemi_locality_t *lp);
+
+/*
+ * as build, but the view comes from the schedule cache, so it must
+ * not be freed, and NULL means no two-level algorithm
+ *
+ */
+extern shmemi_locality_t *shmemi_locality_lookup (int PE_start,
+                                                  int logPE_stride,
+                                                  int PE_size, int root,
+                                                  long *pSync);
+
+/*
+ * where my symmetric "addr" lives on the i'th PE of my host
+ *
+ */
+extern void *shmemi_locality_ptr (shmemi_locality_t *lp,
+                                  const void *addr, int i);
+
+/*
+ * on-node synchronization: "gather" makes the leader wait for the
+ * other PEs on its host, "release" makes them wait for the leader.
+ * These are single flags, so callers must always alternate them,
+ * starting with gather and ending with release.
+ *
+ */
+extern void shmemi_locality_gather (shmemi_locality_t *lp, long *pSync);
+extern void shmemi_locality_release (shmemi_locality_t *lp, long *pSync);
+
+/*
+ * barrier between the leaders only
+ *
+ */
+extern void shmemi_locality_leader_barrier (shmemi_locality_t *lp,
+                                            long *pSync);
+
+#endif /* _LOCALITY_H */
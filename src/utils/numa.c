@@ -0,0 +1,328 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+
+/*
+ * NUMA placement.  The topology comes from sysfs and the policies are
+ * set with the raw system calls, so there's no dependency on libnuma.
+ *
+ */
+
+#define _GNU_SOURCE 1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif /* __linux__ */
+
+#include "state.h"
+#include "trace.h"
+#include "utils.h"
+
+#include "comms/comms.h"
+
+#include "numa.h"
+
+#if defined(__linux__) && defined(SYS_mbind) && defined(SYS_set_mempolicy)
+#define HAVE_NUMA_SYSCALLS 1
+#endif
+
+/*
+ * from <numaif.h>, which needs libnuma's headers
+ */
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#define MPOL_BIND 2
+#define MPOL_INTERLEAVE 3
+#endif /* MPOL_PREFERRED */
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE (1 << 1)
+#endif /* MPOL_MF_MOVE */
+
+#define NUMA_MAX_NODES 1024
+#define MASK_BITS (8 * sizeof (unsigned long))
+#define MASK_LONGS (NUMA_MAX_NODES / MASK_BITS)
+
+#define SYSFS_NODES "/sys/devices/system/node"
+
+static shmemi_numa_policy_t policy = NUMA_POLICY_NONE;
+
+/* all nodes with memory, and the one this PE runs on */
+static unsigned long all_nodes[MASK_LONGS];
+static int nnodes = 0;
+static int my_node = -1;
+
+static cpu_set_t my_cpus;
+
+static inline void
+mask_set (unsigned long *mask, int n)
+{
+    mask[n / MASK_BITS] |= 1UL << (n % MASK_BITS);
+}
+
+/**
+ * read a sysfs cpu list like "0-7,16-23" into SET.  Returns the
+ * number of cpus found.
+ */
+static int
+read_cpulist (const char *path, cpu_set_t *set)
+{
+    FILE *fp = fopen (path, "r");
+    int lo, hi, c;
+    int n = 0;
+
+    CPU_ZERO (set);
+    if (fp == NULL) {
+        return 0;
+    }
+    while (fscanf (fp, "%d", &lo) == 1) {
+        hi = lo;
+        c = fgetc (fp);
+        if (c == '-') {
+            if (fscanf (fp, "%d", &hi) != 1) {
+                break;
+            }
+            c = fgetc (fp);
+        }
+        for (; (lo <= hi) && (lo < CPU_SETSIZE); lo += 1) {
+            CPU_SET (lo, set);
+            n += 1;
+        }
+        if (c != ',') {
+            break;
+        }
+    }
+    fclose (fp);
+    return n;
+}
+
+/**
+ * find the nodes, and which of them holds the cpu we're running on
+ */
+static void
+detect (void)
+{
+    const int cpu = sched_getcpu ();
+    DIR *dp = opendir (SYSFS_NODES);
+    struct dirent *de;
+
+    if (dp == NULL) {
+        return;
+    }
+    while ((de = readdir (dp)) != NULL) {
+        char path[256];
+        cpu_set_t cpus;
+        int n;
+
+        if ((sscanf (de->d_name, "node%d", &n) != 1) ||
+            (n < 0) || (n >= NUMA_MAX_NODES)) {
+            continue;
+        }
+        mask_set (all_nodes, n);
+        nnodes += 1;
+
+        snprintf (path, sizeof (path), SYSFS_NODES "/node%d/cpulist", n);
+        if ((read_cpulist (path, &cpus) > 0) &&
+            (cpu >= 0) && CPU_ISSET (cpu, &cpus)) {
+            my_node = n;
+            my_cpus = cpus;
+        }
+    }
+    closedir (dp);
+}
+
+/**
+ * work out the topology, report it, and pick up the policy
+ */
+void
+shmemi_numa_init (void)
+{
+    char *np = shmemi_comms_getenv ("SHMEM_NUMA_POLICY");
+    int ncpus;
+
+    if (np == (char *) NULL || strcasecmp (np, "none") == 0) {
+        policy = NUMA_POLICY_NONE;
+    }
+    else if (strcasecmp (np, "local") == 0) {
+        policy = NUMA_POLICY_LOCAL;
+    }
+    else if (strcasecmp (np, "interleave") == 0) {
+        policy = NUMA_POLICY_INTERLEAVE;
+    }
+    else {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "unknown NUMA policy \"%s\"", np);
+        return;
+        /* NOT REACHED */
+    }
+
+    detect ();
+
+    if (nnodes == 0 || my_node < 0) {
+        shmemi_trace (SHMEM_LOG_INIT,
+                      "no NUMA topology found, not placing memory");
+        policy = NUMA_POLICY_NONE;
+        return;
+    }
+
+    ncpus = CPU_COUNT (&my_cpus);
+    shmemi_trace (SHMEM_LOG_INIT,
+                  "%d NUMA node%s, running on node %d (%d cpu%s)",
+                  nnodes, (nnodes == 1) ? "" : "s",
+                  my_node, ncpus, (ncpus == 1) ? "" : "s");
+
+    if (nnodes == 1) {
+        policy = NUMA_POLICY_NONE;  /* nothing to choose */
+        return;
+    }
+
+#ifdef HAVE_NUMA_SYSCALLS
+    /*
+     * whatever this PE allocates from now on (segment tables, AM
+     * bounce buffers...) should come from its own node
+     */
+    if (policy != NUMA_POLICY_NONE) {
+        unsigned long mine[MASK_LONGS];
+
+        memset (mine, 0, sizeof (mine));
+        mask_set (mine, my_node);
+        if (syscall (SYS_set_mempolicy, MPOL_PREFERRED,
+                     mine, NUMA_MAX_NODES + 1) != 0) {
+            shmemi_trace (SHMEM_LOG_INIT,
+                          "unable to prefer NUMA node %d (%s)",
+                          my_node, strerror (errno));
+        }
+    }
+#else
+    if (policy != NUMA_POLICY_NONE) {
+        shmemi_trace (SHMEM_LOG_INIT,
+                      "NUMA placement not supported on this platform");
+        policy = NUMA_POLICY_NONE;
+    }
+#endif /* HAVE_NUMA_SYSCALLS */
+}
+
+shmemi_numa_policy_t
+shmemi_numa_policy (void)
+{
+    return policy;
+}
+
+/**
+ * bind the heap at [ADDR, ADDR + LEN) according to the policy.  Pages
+ * already touched are moved.
+ */
+void
+shmemi_numa_place_heap (void *addr, size_t len)
+{
+#ifdef HAVE_NUMA_SYSCALLS
+    unsigned long mask[MASK_LONGS];
+    int mode;
+
+    switch (policy) {
+    case NUMA_POLICY_LOCAL:
+        memset (mask, 0, sizeof (mask));
+        mask_set (mask, my_node);
+        mode = MPOL_BIND;
+        break;
+    case NUMA_POLICY_INTERLEAVE:
+        memcpy (mask, all_nodes, sizeof (mask));
+        mode = MPOL_INTERLEAVE;
+        break;
+    default:
+        return;
+    }
+
+    if (syscall (SYS_mbind, addr, len, mode,
+                 mask, NUMA_MAX_NODES + 1, MPOL_MF_MOVE) != 0) {
+        shmemi_trace (SHMEM_LOG_INIT,
+                      "unable to place symmetric heap (%s)",
+                      strerror (errno));
+        return;
+    }
+
+    shmemi_trace (SHMEM_LOG_INIT,
+                  "symmetric heap %s",
+                  (policy == NUMA_POLICY_LOCAL) ?
+                  "bound to local NUMA node" :
+                  "interleaved over all NUMA nodes");
+#endif /* HAVE_NUMA_SYSCALLS */
+}
+
+/**
+ * keep THR (the progress thread) on the cpus of this PE's node
+ */
+void
+shmemi_numa_place_thread (pthread_t thr)
+{
+    int s;
+
+    if (policy == NUMA_POLICY_NONE) {
+        return;
+    }
+
+    s = pthread_setaffinity_np (thr, sizeof (my_cpus), &my_cpus);
+    if (s != 0) {
+        shmemi_trace (SHMEM_LOG_INIT,
+                      "unable to move progress thread to NUMA node %d (%s)",
+                      my_node, strerror (s));
+    }
+}
@@ -0,0 +1,219 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "state.h"
+#include "trace.h"
+#include "utils.h"
+
+#include "comms/comms.h"
+
+#include "schedule.h"
+
+/*
+ * Collectives keep working out the same trees and neighbour lists,
+ * since programs tend to call them over and over on the same set of
+ * PEs.  Keep the last few here.  There are only a handful, so a scan
+ * is as quick as anything cleverer, and the least recently used one
+ * is thrown out when we run out of room.
+ *
+ */
+
+#define SCHEDULE_DEFAULT_ENTRIES 32
+
+typedef struct
+{
+    int used;                   /* anything in here? */
+    shmemi_schedule_kind_t kind;
+    int PE_start;
+    int logPE_stride;
+    int PE_size;
+    int root;
+
+    void *sched;
+    shmemi_schedule_destroy_t destroy;
+
+    unsigned long last;         /* when last looked up */
+} schedule_entry_t;
+
+static schedule_entry_t *entries = NULL;
+static int nentries = 0;
+static int recent = 0;          /* where the last hit was */
+static unsigned long now = 0;
+
+static inline int
+matches (const schedule_entry_t *e, shmemi_schedule_kind_t kind,
+         int PE_start, int logPE_stride, int PE_size, int root)
+{
+    return e->used &&
+        (e->kind == kind) &&
+        (e->PE_start == PE_start) &&
+        (e->logPE_stride == logPE_stride) &&
+        (e->PE_size == PE_size) &&
+        (e->root == root);
+}
+
+static void
+entry_clear (schedule_entry_t *e)
+{
+    if (e->used && (e->sched != NULL)) {
+        (*e->destroy) (e->sched);
+    }
+    e->used = 0;
+    e->sched = NULL;
+}
+
+/**
+ * SHMEM_SCHEDULE_CACHE_SIZE can change the number of entries.  At
+ * least 2 are kept, so that a schedule can't be thrown out by the
+ * very next lookup.
+ */
+void
+shmemi_schedule_init (void)
+{
+    char *ns = shmemi_comms_getenv ("SHMEM_SCHEDULE_CACHE_SIZE");
+
+    nentries = SCHEDULE_DEFAULT_ENTRIES;
+    if (ns != (char *) NULL) {
+        nentries = atoi (ns);
+        if (nentries < 2) {
+            nentries = 2;
+        }
+    }
+
+    entries = (schedule_entry_t *) calloc (nentries, sizeof (*entries));
+    if (EXPR_UNLIKELY (entries == (schedule_entry_t *) NULL)) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "internal error: cannot allocate memory for"
+                      " schedule cache");
+        return;
+        /* NOT REACHED */
+    }
+
+    shmemi_trace (SHMEM_LOG_INIT,
+                  "caching up to %d collective schedules", nentries);
+}
+
+void
+shmemi_schedule_finalize (void)
+{
+    int i;
+
+    for (i = 0; i < nentries; i += 1) {
+        entry_clear (&entries[i]);
+    }
+    free (entries);
+    entries = NULL;
+    nentries = 0;
+}
+
+void *
+shmemi_schedule_lookup (shmemi_schedule_kind_t kind,
+                        int PE_start, int logPE_stride,
+                        int PE_size, int root,
+                        shmemi_schedule_build_t build,
+                        shmemi_schedule_destroy_t destroy)
+{
+    schedule_entry_t *e;
+    int victim = 0;
+    int i;
+
+    now += 1;
+
+    /* usually the same as last time */
+    e = &entries[recent];
+    if (EXPR_LIKELY (matches (e, kind,
+                              PE_start, logPE_stride, PE_size, root))) {
+        e->last = now;
+        return e->sched;
+    }
+
+    for (i = 0; i < nentries; i += 1) {
+        e = &entries[i];
+        if (matches (e, kind, PE_start, logPE_stride, PE_size, root)) {
+            e->last = now;
+            recent = i;
+            return e->sched;
+        }
+        if (! entries[victim].used) {
+            continue;
+        }
+        if ((! e->used) || (e->last < entries[victim].last)) {
+            victim = i;
+        }
+    }
+
+    e = &entries[victim];
+    if (e->used) {
+        shmemi_trace (SHMEM_LOG_CACHE,
+                      "evicting schedule for %d PEs from %d,"
+                      " stride 2^%d, root %d",
+                      e->PE_size, e->PE_start, e->logPE_stride, e->root);
+    }
+    entry_clear (e);
+
+    e->kind = kind;
+    e->PE_start = PE_start;
+    e->logPE_stride = logPE_stride;
+    e->PE_size = PE_size;
+    e->root = root;
+    e->sched = (*build) (PE_start, logPE_stride, PE_size, root);
+    e->destroy = destroy;
+    e->last = now;
+    e->used = 1;
+
+    recent = victim;
+
+    return e->sched;
+}
@@ -104,6 +104,7 @@ static trace_table_t tracers[] = {
     INIT_STATE (ATOMIC, OFF),
     INIT_STATE (AUTH, OFF),
     INIT_STATE (BARRIER, OFF),
+    INIT_STATE (ALLTOALL, OFF),
     INIT_STATE (BROADCAST, OFF),
     INIT_STATE (REDUCTION, OFF),
     INIT_STATE (CACHE, OFF),
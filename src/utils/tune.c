@@ -0,0 +1,604 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+
+#include "state.h"
+#include "trace.h"
+#include "utils.h"
+#include "clock.h"
+#include "memalloc.h"
+
+#include "comms/comms.h"
+
+#include "shmem.h"
+
+#ifdef HAVE_FEATURE_EXPERIMENTAL
+#include "shmemx.h"
+#ifdef HAVE_FEATURE_PSHMEM
+#include "pshmemx.h"
+#endif /* HAVE_FEATURE_PSHMEM */
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
+
+#include "tune.h"
+
+/*
+ * Per-call algorithm selection.  Each collective's dispatcher
+ * registers its list of algorithms here.  If SHMEM_TUNING_FILE names
+ * a table, PE 0 reads it and broadcasts it so every PE makes the
+ * same choice for the same call, which they must or the algorithms
+ * won't match up.  An explicit SHMEM_<coll>_ALGORITHM still wins.
+ *
+ * The file is plain text, one range per line:
+ *
+ *   # collective  min_pes  max_pes  min_bytes  max_bytes  algorithm
+ *   broadcast     2        7        0          4095       linear
+ *
+ * Ranges are widened to whole powers of 2, and later lines override
+ * earlier ones.  Bytes are per PE.  For collect, where PEs can
+ * contribute different amounts, only the PE count is used.
+ *
+ */
+
+shmemi_tune_table_t *shmemi_tune_table = NULL;
+
+static struct
+{
+    const shmemi_tune_algorithm_t *algs;
+    int nalgs;
+} registry[TUNE_NUM_COLLECTIVES];
+
+static char *coll_names[TUNE_NUM_COLLECTIVES] = {
+    "barrier",
+    "broadcast",
+    "collect",
+    "fcollect",
+    "alltoall"
+};
+
+/**
+ * dispatchers call this during initialization
+ */
+void
+shmemi_tune_register (shmemi_tune_coll_t c,
+                      const shmemi_tune_algorithm_t *algs, int nalgs)
+{
+    registry[c].algs = algs;
+    registry[c].nalgs = nalgs;
+}
+
+/**
+ * index of the named algorithm in the list, or -1
+ */
+int
+shmemi_tune_find (const shmemi_tune_algorithm_t *algs, int nalgs,
+                  const char *name)
+{
+    int i;
+
+    for (i = 0; i < nalgs; i += 1) {
+        if (strcmp (algs[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int
+coll_by_name (const char *name)
+{
+    int c;
+
+    for (c = 0; c < TUNE_NUM_COLLECTIVES; c += 1) {
+        if (strcmp (coll_names[c], name) == 0) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+static void
+fill_range (shmemi_tune_table_t *t, int c, int a,
+            size_t min_pes, size_t max_pes,
+            size_t min_bytes, size_t max_bytes)
+{
+    int pb, sb;
+
+    for (pb = shmemi_tune_bucket (min_pes);
+         pb <= shmemi_tune_bucket (max_pes); pb += 1) {
+        for (sb = shmemi_tune_bucket (min_bytes);
+             sb <= shmemi_tune_bucket (max_bytes); sb += 1) {
+            (*t)[c][pb][sb] = (signed char) a;
+        }
+    }
+}
+
+/**
+ * parse the tuning file into "t", return # of ranges used
+ */
+static int
+load_table (const char *path, shmemi_tune_table_t *t)
+{
+    FILE *fp = fopen (path, "r");
+    char line[256];
+    int lineno = 0;
+    int n = 0;
+
+    if (EXPR_UNLIKELY (fp == (FILE *) NULL)) {
+        shmemi_trace (SHMEM_LOG_INFO,
+                      "unable to read tuning file \"%s\" (%s)",
+                      path, strerror (errno));
+        return 0;
+    }
+
+    while (fgets (line, sizeof (line), fp) != NULL) {
+        char coll[32];
+        char alg[64];
+        unsigned long long min_pes, max_pes, min_bytes, max_bytes;
+        const char *p = line + strspn (line, " \t");
+        int c, a;
+
+        lineno += 1;
+
+        if ((*p == '#') || (*p == '\n') || (*p == '\0')) {
+            continue;
+        }
+        if (sscanf (p, "%31s %llu %llu %llu %llu %63s",
+                    coll, &min_pes, &max_pes,
+                    &min_bytes, &max_bytes, alg) != 6) {
+            shmemi_trace (SHMEM_LOG_INFO,
+                          "%s:%d: ignoring malformed tuning entry",
+                          path, lineno);
+            continue;
+        }
+        c = coll_by_name (coll);
+        if (c < 0) {
+            shmemi_trace (SHMEM_LOG_INFO,
+                          "%s:%d: unknown collective \"%s\"",
+                          path, lineno, coll);
+            continue;
+        }
+        a = shmemi_tune_find (registry[c].algs, registry[c].nalgs, alg);
+        if (a < 0) {
+            shmemi_trace (SHMEM_LOG_INFO,
+                          "%s:%d: unknown %s algorithm \"%s\"",
+                          path, lineno, coll, alg);
+            continue;
+        }
+
+        fill_range (t, c, a,
+                    (size_t) min_pes, (size_t) max_pes,
+                    (size_t) min_bytes, (size_t) max_bytes);
+        n += 1;
+    }
+
+    fclose (fp);
+
+    return n;
+}
+
+/**
+ * called during initialization of shmem, once the collectives are
+ * up
+ */
+void
+shmemi_tune_init (void)
+{
+    char *path = shmemi_comms_getenv ("SHMEM_TUNING_FILE");
+    shmemi_tune_table_t *t;
+    long *pSync;
+    int i;
+    int n = 0;
+
+    if (EXPR_LIKELY (path == (char *) NULL)) {
+        return;
+    }
+
+    t = (shmemi_tune_table_t *) shmemi_mem_alloc (sizeof (*t));
+    pSync = (long *) shmemi_mem_alloc (SHMEM_BCAST_SYNC_SIZE *
+                                       sizeof (*pSync));
+    if (EXPR_UNLIKELY ((t == NULL) || (pSync == NULL))) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "internal error: unable to allocate symmetric"
+                      " memory for tuning table");
+        return;
+        /* NOT REACHED */
+    }
+
+    memset (t, -1, sizeof (*t));
+    for (i = 0; i < SHMEM_BCAST_SYNC_SIZE; i += 1) {
+        pSync[i] = SHMEM_SYNC_VALUE;
+    }
+
+    if (GET_STATE (mype) == 0) {
+        n = load_table (path, t);
+    }
+
+    shmem_barrier_all ();
+    shmem_broadcast64 (t, t, sizeof (*t) / sizeof (long),
+                       0, 0, 0, GET_STATE (numpes), pSync);
+    shmem_barrier_all ();
+
+    shmemi_mem_free (pSync);
+
+    shmemi_tune_table = t;
+
+    if (GET_STATE (mype) == 0) {
+        shmemi_trace (SHMEM_LOG_INIT,
+                      "using %d entr%s from tuning file \"%s\"",
+                      n, (n == 1) ? "y" : "ies", path);
+    }
+}
+
+#ifdef HAVE_FEATURE_EXPERIMENTAL
+
+/*
+ * Benchmarking: time every registered algorithm of every collective
+ * over PEs 0..n-1 for n = 2, 4, 8, ... (and the full job for the
+ * largest bucket) and a spread of message sizes, then write the
+ * winners out as a tuning file.  Times are the slowest PE's, so all
+ * PEs pick the same winners and can use them straight away.
+ *
+ */
+
+#define TUNE_MIN_LOG_BYTES      3
+#define TUNE_MAX_LOG_BYTES      18
+#define TUNE_LOG_BYTES_STEP     3
+#define TUNE_COLLECT_LOG_BYTES  10
+#define TUNE_SCRATCH_BYTES      (8L * 1024L * 1024L)
+
+static long *bench_psync;
+static long *bench_barrier_psync;
+static long *bench_reduce_psync;
+static double *bench_time;
+static double *bench_wrk;
+static char *bench_source;
+static char *bench_target;
+
+static int
+bench_alloc (void)
+{
+    int i;
+
+    bench_psync = shmemi_mem_alloc (SHMEM_REDUCE_SYNC_SIZE * sizeof (long));
+    bench_barrier_psync =
+        shmemi_mem_alloc (SHMEM_BARRIER_SYNC_SIZE * sizeof (long));
+    bench_reduce_psync =
+        shmemi_mem_alloc (SHMEM_REDUCE_SYNC_SIZE * sizeof (long));
+    bench_time = shmemi_mem_alloc (2 * sizeof (double));
+    bench_wrk =
+        shmemi_mem_alloc (SHMEM_REDUCE_MIN_WRKDATA_SIZE * sizeof (double));
+    bench_source = shmemi_mem_alloc (TUNE_SCRATCH_BYTES);
+    bench_target = shmemi_mem_alloc (TUNE_SCRATCH_BYTES);
+
+    if ((bench_psync == NULL) || (bench_barrier_psync == NULL) ||
+        (bench_reduce_psync == NULL) || (bench_time == NULL) ||
+        (bench_wrk == NULL) ||
+        (bench_source == NULL) || (bench_target == NULL)) {
+        return 0;
+    }
+
+    for (i = 0; i < SHMEM_REDUCE_SYNC_SIZE; i += 1) {
+        bench_psync[i] = SHMEM_SYNC_VALUE;
+        bench_reduce_psync[i] = SHMEM_SYNC_VALUE;
+    }
+    for (i = 0; i < SHMEM_BARRIER_SYNC_SIZE; i += 1) {
+        bench_barrier_psync[i] = SHMEM_SYNC_VALUE;
+    }
+    memset (bench_source, 0, TUNE_SCRATCH_BYTES);
+
+    return 1;
+}
+
+static void
+bench_free (void)
+{
+    shmemi_mem_free (bench_target);
+    shmemi_mem_free (bench_source);
+    shmemi_mem_free (bench_wrk);
+    shmemi_mem_free (bench_time);
+    shmemi_mem_free (bench_reduce_psync);
+    shmemi_mem_free (bench_barrier_psync);
+    shmemi_mem_free (bench_psync);
+}
+
+/**
+ * can we run this case in the scratch buffers?
+ */
+static int
+bench_fits (shmemi_tune_coll_t c, int PE_size, size_t nbytes)
+{
+    switch (c) {
+    case TUNE_BROADCAST:
+        return nbytes <= TUNE_SCRATCH_BYTES;
+    case TUNE_COLLECT:
+    case TUNE_FCOLLECT:
+    case TUNE_ALLTOALL:
+        return (size_t) PE_size * nbytes <= TUNE_SCRATCH_BYTES;
+    default:
+        return 1;
+    }
+}
+
+static void
+bench_run (shmemi_tune_coll_t c, const shmemi_tune_algorithm_t *a,
+           int PE_size, size_t nbytes)
+{
+    const size_t nelems = nbytes / sizeof (long);
+    long *pSync = bench_psync;
+
+    switch (c) {
+    case TUNE_BARRIER:
+        (*a->func32) (0, 0, PE_size, pSync);
+        return;
+    case TUNE_BROADCAST:
+        (*a->func64) (bench_target, bench_source, nelems,
+                      0, 0, 0, PE_size, pSync);
+        break;
+    case TUNE_COLLECT:
+    case TUNE_FCOLLECT:
+        (*a->func64) (bench_target, bench_source, nelems,
+                      0, 0, PE_size, pSync);
+        break;
+    case TUNE_ALLTOALL:
+        (*a->func64) (bench_target, bench_source, 1, 1, nelems,
+                      0, 0, PE_size, pSync);
+        break;
+    default:
+        break;
+    }
+
+    /* pSync can't be reused until everyone is done with it */
+    shmem_barrier (0, 0, PE_size, bench_barrier_psync);
+}
+
+/**
+ * time per call on the slowest PE
+ */
+static double
+bench_one (shmemi_tune_coll_t c, const shmemi_tune_algorithm_t *a,
+           int PE_size, size_t nbytes)
+{
+    const int reps = (nbytes <= 4096) ? 50 : 10;
+    double t = 0.0;
+    int r;
+
+    shmem_barrier_all ();
+
+    if (GET_STATE (mype) < PE_size) {
+        /* warm up */
+        bench_run (c, a, PE_size, nbytes);
+        bench_run (c, a, PE_size, nbytes);
+
+        t = shmemi_elapsed_clock_get ();
+        for (r = 0; r < reps; r += 1) {
+            bench_run (c, a, PE_size, nbytes);
+        }
+        t = (shmemi_elapsed_clock_get () - t) / reps;
+    }
+
+    bench_time[0] = t;
+    shmem_barrier_all ();
+    shmem_double_max_to_all (&bench_time[1], &bench_time[0], 1,
+                             0, 0, GET_STATE (numpes),
+                             bench_wrk, bench_reduce_psync);
+    return bench_time[1];
+}
+
+/**
+ * message sizes to try, as powers of 2
+ */
+static void
+bench_sizes (shmemi_tune_coll_t c, int *first, int *last)
+{
+    switch (c) {
+    case TUNE_BARRIER:
+        *first = *last = 0;
+        break;
+    case TUNE_COLLECT:
+        *first = *last = TUNE_COLLECT_LOG_BYTES;
+        break;
+    default:
+        *first = TUNE_MIN_LOG_BYTES;
+        *last = TUNE_MAX_LOG_BYTES;
+        break;
+    }
+}
+
+/**
+ * find and record the winner for every size we can try on PE_size
+ * PEs; the ranges between sizes tried go to the smaller size
+ */
+static void
+bench_pes (shmemi_tune_coll_t c, shmemi_tune_table_t *t, FILE *fp,
+           int PE_size, size_t min_pes, size_t max_pes)
+{
+    const shmemi_tune_algorithm_t *algs = registry[c].algs;
+    const int nalgs = registry[c].nalgs;
+    size_t min_bytes = 0;
+    int first, last, lb;
+
+    bench_sizes (c, &first, &last);
+
+    for (lb = first; lb <= last; lb += TUNE_LOG_BYTES_STEP) {
+        const size_t nbytes = (c == TUNE_BARRIER) ? 0 : ((size_t) 1 << lb);
+        const int next = lb + TUNE_LOG_BYTES_STEP;
+        int final;
+        size_t max_bytes;
+        double best_time = 0.0;
+        int best = -1;
+        int a;
+
+        if (!bench_fits (c, PE_size, nbytes)) {
+            break;
+        }
+        final = (next > last) ||
+            !bench_fits (c, PE_size, (size_t) 1 << next);
+        max_bytes = final ? (size_t) -1 : ((size_t) 1 << next) - 1;
+
+        for (a = 0; a < nalgs; a += 1) {
+            const double secs = bench_one (c, &algs[a], PE_size, nbytes);
+
+            shmemi_trace (SHMEM_LOG_INFO,
+                          "tuning %s on %d PEs, %lu bytes: \"%s\" %g s",
+                          coll_names[c], PE_size, (unsigned long) nbytes,
+                          algs[a].name, secs);
+            if ((best < 0) || (secs < best_time)) {
+                best = a;
+                best_time = secs;
+            }
+        }
+
+        fill_range (t, c, best, min_pes, max_pes, min_bytes, max_bytes);
+        if (fp != NULL) {
+            fprintf (fp, "%-10s %8lu %8lu %10lu %20lu  %s\n",
+                     coll_names[c],
+                     (unsigned long) min_pes, (unsigned long) max_pes,
+                     (unsigned long) min_bytes, (unsigned long) max_bytes,
+                     algs[best].name);
+        }
+
+        if (final) {
+            break;
+        }
+        min_bytes = max_bytes + 1;
+    }
+}
+
+#ifdef HAVE_FEATURE_PSHMEM
+#pragma weak shmemx_collective_tune = pshmemx_collective_tune
+#define shmemx_collective_tune pshmemx_collective_tune
+#endif /* HAVE_FEATURE_PSHMEM */
+
+void
+shmemx_collective_tune (const char *path)
+{
+    DEBUG_NAME ("shmemx_collective_tune");
+    const int npes = GET_STATE (numpes);
+    shmemi_tune_table_t *t;
+    FILE *fp = NULL;
+    int c, b;
+
+    INIT_CHECK (debug_name);
+
+    if (EXPR_UNLIKELY (!bench_alloc ())) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "unable to allocate symmetric memory for tuning");
+        return;
+        /* NOT REACHED */
+    }
+
+    t = (shmemi_tune_table_t *) malloc (sizeof (*t));
+    if (EXPR_UNLIKELY (t == NULL)) {
+        shmemi_trace (SHMEM_LOG_FATAL,
+                      "internal error: unable to allocate tuning table");
+        return;
+        /* NOT REACHED */
+    }
+    memset (t, -1, sizeof (*t));
+
+    if ((GET_STATE (mype) == 0) && (path != NULL)) {
+        fp = fopen (path, "w");
+        if (EXPR_UNLIKELY (fp == (FILE *) NULL)) {
+            shmemi_trace (SHMEM_LOG_INFO,
+                          "unable to write tuning file \"%s\" (%s)",
+                          path, strerror (errno));
+        }
+        else {
+            fprintf (fp, "# collective tuning table, measured on %d PEs\n",
+                     npes);
+            fprintf (fp, "# collective  min_pes  max_pes"
+                     "  min_bytes  max_bytes  algorithm\n");
+        }
+    }
+
+    for (c = 0; c < TUNE_NUM_COLLECTIVES; c += 1) {
+        if (registry[c].nalgs < 2) {
+            continue;
+        }
+        for (b = 1; (1 << b) <= npes; b += 1) {
+            /* the largest bucket is timed on all PEs and left open */
+            const int top = (npes >> (b + 1)) == 0;
+            const int PE_size = top ? npes : (1 << b);
+            const size_t max_pes = top ? (size_t) INT_MAX :
+                ((size_t) 1 << (b + 1)) - 1;
+
+            bench_pes ((shmemi_tune_coll_t) c, t, fp,
+                       PE_size, (size_t) 1 << b, max_pes);
+        }
+    }
+
+    if (fp != NULL) {
+        fclose (fp);
+    }
+
+    shmem_barrier_all ();
+    bench_free ();
+
+    /*
+     * every PE saw the same times, so the table is the same
+     * everywhere and can be used for the rest of this run
+     */
+    if (shmemi_tune_table == NULL) {
+        shmemi_tune_table = t;
+    }
+    else {
+        memcpy (shmemi_tune_table, t, sizeof (*t));
+        free (t);
+    }
+}
+
+#endif /* HAVE_FEATURE_EXPERIMENTAL */
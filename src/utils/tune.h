@@ -0,0 +1,135 @@
+/*
+ *
+ * Copyright (c) 2016
+ *   Stony Brook University
+ * Copyright (c) 2015 - 2016
+ *   Los Alamos National Security, LLC.
+ * Copyright (c) 2011 - 2016
+ *   University of Houston System and UT-Battelle, LLC.
+ * Copyright (c) 2009 - 2016
+ *   Silicon Graphics International Corp.  SHMEM is copyrighted
+ *   by Silicon Graphics International Corp. (SGI) The OpenSHMEM API
+ *   (shmem) is released by Open Source Software Solutions, Inc., under an
+ *   agreement with Silicon Graphics International Corp. (SGI).
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * o Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimers.
+ *
+ * o Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * o Neither the name of the University of Houston System,
+ *   UT-Battelle, LLC. nor the names of its contributors may be used to
+ *   endorse or promote products derived from this software without specific
+ *   prior written permission.
+ *
+ * o Neither the name of Los Alamos National Security, LLC, Los Alamos
+ *   National Laboratory, LANL, the U.S. Government, nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef _TUNE_H
+#define _TUNE_H 1
+
+#include <sys/types.h>
+
+/*
+ * collectives whose algorithm can be chosen per call
+ *
+ */
+typedef enum
+{
+    TUNE_BARRIER = 0,
+    TUNE_BROADCAST,
+    TUNE_COLLECT,
+    TUNE_FCOLLECT,
+    TUNE_ALLTOALL,
+    TUNE_NUM_COLLECTIVES
+} shmemi_tune_coll_t;
+
+/*
+ * one implementation of a collective, as listed by its dispatcher.
+ * Barrier has no 32/64-bit split and only uses func32.  funcmem is
+ * the byte-count (or, for alltoall, variable-count) version, NULL
+ * where the collective has none.
+ *
+ */
+typedef struct
+{
+    char *name;
+    void (*func32) ();
+    void (*func64) ();
+    void (*funcmem) ();
+} shmemi_tune_algorithm_t;
+
+#define TUNE_COUNT(a) ((int) (sizeof (a) / sizeof ((a)[0])))
+
+/*
+ * the table is bucketed by powers of 2 of both the PE count and the
+ * bytes per PE; an entry is an index into the collective's list of
+ * algorithms, or -1 to use its default
+ *
+ */
+#define TUNE_BUCKETS 32
+
+typedef signed char shmemi_tune_table_t[TUNE_NUM_COLLECTIVES]
+                                       [TUNE_BUCKETS][TUNE_BUCKETS];
+
+extern shmemi_tune_table_t *shmemi_tune_table;
+
+extern void shmemi_tune_register (shmemi_tune_coll_t c,
+                                  const shmemi_tune_algorithm_t *algs,
+                                  int nalgs);
+extern int shmemi_tune_find (const shmemi_tune_algorithm_t *algs,
+                             int nalgs, const char *name);
+extern void shmemi_tune_init (void);
+
+static inline int
+shmemi_tune_bucket (size_t n)
+{
+    int b = 0;
+
+    while ((n > 1) && (b < TUNE_BUCKETS - 1)) {
+        n >>= 1;
+        b += 1;
+    }
+    return b;
+}
+
+/**
+ * which algorithm the tuning table wants for this call, or -1
+ */
+static inline int
+shmemi_tune_lookup (shmemi_tune_coll_t c, int PE_size, size_t nbytes)
+{
+    if (shmemi_tune_table == NULL) {
+        return -1;
+    }
+    return (*shmemi_tune_table)[c]
+        [shmemi_tune_bucket ((size_t) PE_size)]
+        [shmemi_tune_bucket (nbytes)];
+}
+
+#endif /* _TUNE_H */